@@ -1,10 +1,23 @@
 #include "address_set_adapter.h"
+#include "cache_model.h"
+#include "evlist.h"
+#include "timing.h"
+#include "traversal.h"
+#include "oracle_trace.h"
 
 #include <gem5/m5ops.h>
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Deepest hit level that still counts as a hit for the context's target level
+static inline uint64_t target_level(const test_context_t *context)
+{
+    return context->target_level ? (uint64_t)context->target_level : 2;
+}
 
 // ---- m5-op eviction oracle ----
 static int m5op_eviction_test(const address_set_t *set,
@@ -17,19 +30,16 @@ static int m5op_eviction_test(const address_set_t *set,
     (void)tmp;
     asm volatile("" ::: "memory");
 
-    for (size_t i = 0; i < set->size; i++) {
-        volatile uint8_t *p = (volatile uint8_t *)set->addresses[i];
-        tmp = *p;
-    }
-    (void)tmp;
-    asm volatile("" ::: "memory");
+    traverse_pattern(set, context->pattern, NULL, NULL);
 
     tmp = *target;
     (void)tmp;
 
     uint64_t lvl = m5_get_last_hit_level();
-    printf("the m5op returned %d\n", lvl);
-    return (lvl == 3); // 3 => miss/evicted, 1/2 => hit
+    int evicted = lvl > target_level(context); // beyond the target level => evicted from it
+    oracle_trace_record(context->trace, ORACLE_TRACE_SINGLE, set->size, evicted, lvl,
+                        context->trace ? m5_rpns() : 0);
+    return evicted;
 }
 
 eviction_test_func_t create_eviction_tester(void)
@@ -37,47 +47,448 @@ eviction_test_func_t create_eviction_tester(void)
     return m5op_eviction_test;
 }
 
+static uint64_t m5op_batch_eviction_test(const address_set_t *set,
+                                         void *const *targets,
+                                         size_t num_targets,
+                                         const test_context_t *context)
+{
+    uint64_t level = target_level(context);
+    volatile uint8_t tmp;
+
+    for (size_t t = 0; t < num_targets; t++)
+        tmp = *(volatile uint8_t *)targets[t];
+    asm volatile("" ::: "memory");
+
+    traverse_pattern(set, context->pattern, NULL, NULL);
+
+    // Sample the hit level right after each reload, before the next access
+    uint64_t evicted = 0;
+    for (size_t t = 0; t < num_targets; t++) {
+        tmp = *(volatile uint8_t *)targets[t];
+        if (m5_get_last_hit_level() > level) evicted |= 1ull << t;
+    }
+    (void)tmp;
+    oracle_trace_record(context->trace, ORACLE_TRACE_BATCH, set->size,
+                        __builtin_popcountll(evicted), 0, context->trace ? m5_rpns() : 0);
+    return evicted;
+}
+
+batch_eviction_test_func_t create_batch_eviction_tester(void)
+{
+    return m5op_batch_eviction_test;
+}
+
+// ---- Software cache-model oracle ----
+static void model_visit(uintptr_t addr, void *model)
+{
+    cache_model_access((cache_model_t *)model, addr);
+}
+
+// Same prime / traverse / reload sequence as the m5-op oracle, answered by the model
+static int cache_model_eviction_test(const address_set_t *set,
+                                     const test_context_t *context)
+{
+    cache_model_t *model = (cache_model_t *)context->oracle_state;
+    uintptr_t target = (uintptr_t)context->target_address;
+    if (!model || !target) return 0;
+
+    cache_model_access(model, target);
+
+    traverse_pattern(set, context->pattern, model_visit, model);
+
+    int evicted = !cache_model_access(model, target);
+    oracle_trace_record(context->trace, ORACLE_TRACE_SINGLE, set->size, evicted, 0, 0);
+    return evicted;
+}
+
+eviction_test_func_t create_cache_model_tester(void)
+{
+    return cache_model_eviction_test;
+}
+
+static uint64_t cache_model_batch_eviction_test(const address_set_t *set,
+                                                void *const *targets,
+                                                size_t num_targets,
+                                                const test_context_t *context)
+{
+    cache_model_t *model = (cache_model_t *)context->oracle_state;
+    if (!model) return 0;
+
+    for (size_t t = 0; t < num_targets; t++)
+        cache_model_access(model, (uintptr_t)targets[t]);
+
+    traverse_pattern(set, context->pattern, model_visit, model);
+
+    uint64_t evicted = 0;
+    for (size_t t = 0; t < num_targets; t++) {
+        if (!cache_model_access(model, (uintptr_t)targets[t])) evicted |= 1ull << t;
+    }
+    oracle_trace_record(context->trace, ORACLE_TRACE_BATCH, set->size,
+                        __builtin_popcountll(evicted), 0, 0);
+    return evicted;
+}
+
+batch_eviction_test_func_t create_cache_model_batch_tester(void)
+{
+    return cache_model_batch_eviction_test;
+}
+
+// ---- Timing oracle ----
+// Same sequence again, the reload is timed against the calibrated eviction threshold
+static int timing_eviction_test(const address_set_t *set,
+                                const test_context_t *context)
+{
+    const cache_timing_t *timing = (const cache_timing_t *)context->calibration_data;
+    volatile uint8_t *target = (volatile uint8_t *)context->target_address;
+    if (!timing || !target) return 0;
+
+    volatile uint8_t tmp = *target;
+    asm volatile("" ::: "memory");
+
+    traverse_pattern(set, context->pattern, NULL, NULL);
+    (void)tmp;
+    memory_fence();
+
+    int evicted = measure_access_time(target) >
+                  cache_timing_level_threshold(timing, context->target_level);
+    oracle_trace_record(context->trace, ORACLE_TRACE_SINGLE, set->size, evicted, 0, 0);
+    return evicted;
+}
+
+eviction_test_func_t create_timing_tester(void)
+{
+    return timing_eviction_test;
+}
+
+static uint64_t timing_batch_eviction_test(const address_set_t *set,
+                                           void *const *targets,
+                                           size_t num_targets,
+                                           const test_context_t *context)
+{
+    const cache_timing_t *timing = (const cache_timing_t *)context->calibration_data;
+    if (!timing) return 0;
+    volatile uint8_t tmp;
+
+    for (size_t t = 0; t < num_targets; t++)
+        tmp = *(volatile uint8_t *)targets[t];
+    asm volatile("" ::: "memory");
+
+    traverse_pattern(set, context->pattern, NULL, NULL);
+    (void)tmp;
+    memory_fence();
+
+    uint64_t threshold = cache_timing_level_threshold(timing, context->target_level);
+    uint64_t evicted = 0;
+    for (size_t t = 0; t < num_targets; t++) {
+        if (measure_access_time(targets[t]) > threshold) evicted |= 1ull << t;
+    }
+    oracle_trace_record(context->trace, ORACLE_TRACE_BATCH, set->size,
+                        __builtin_popcountll(evicted), 0, 0);
+    return evicted;
+}
+
+batch_eviction_test_func_t create_timing_batch_tester(void)
+{
+    return timing_batch_eviction_test;
+}
+
+// Fisher-Yates shuffle, from rand() when @rng is NULL
+static void shuffle_addresses(uintptr_t *addresses, size_t n, prng_t *rng)
+{
+    if (n < 2) return;
+    for (size_t i = n - 1; i > 0; i--) {
+        size_t j = rng ? prng_below(rng, i + 1) : (size_t)rand() % (i + 1);
+        uintptr_t tmp = addresses[i];
+        addresses[i] = addresses[j];
+        addresses[j] = tmp;
+    }
+}
+
 // ---- Candidate generation (your original code) ----
 address_set_t generate_candidate_set(void *target_addr,
                                      size_t num_candidates,
                                      const cache_config_t *cfg)
 {
-    size_t l2_size = cfg->l2_size;
-    size_t num_sets = l2_size / (cfg->cache_line_size * cfg->associativity);
-    size_t stride = num_sets * cfg->cache_line_size;
+    return generate_candidate_set_r(target_addr, num_candidates, cfg, NULL);
+}
+
+/*
+* Stride-aligned anonymous reservation so that every candidate lands inside the chunk
+* Nothing is faulted in here: only the candidate lines are written, by touch_line()
+*/
+static pool_chunk_t *alloc_pool_chunk(size_t align, size_t bytes)
+{
+    pool_chunk_t *chunk = malloc(sizeof(pool_chunk_t));
+    if (!chunk) {
+        perror("malloc pool chunk");
+        exit(1);
+    }
 
-    const size_t total_bytes = num_candidates * stride;
-    uint8_t *pool = (uint8_t*)aligned_alloc(cfg->cache_line_size, total_bytes);
-    if (!pool) {
-        perror("aligned_alloc failed");
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t slack = align > page ? align : 0;
+    size_t span = bytes + slack;
+
+    uint8_t *raw = mmap(NULL, span, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (raw == MAP_FAILED) {
+        perror("mmap candidate pool");
         exit(1);
     }
 
-    memset(pool, 0xA5, total_bytes);
+    // Trim the alignment slack on both sides
+    uintptr_t base = slack ? (((uintptr_t)raw + align - 1) & ~(uintptr_t)(align - 1))
+                           : (uintptr_t)raw;
+    size_t head = base - (uintptr_t)raw;
+    size_t tail = span - head - bytes;
+    if (head) munmap(raw, head);
+    if (tail) munmap((uint8_t *)base + bytes, tail);
+
+    chunk->next = NULL;
+    chunk->base = (void *)base;
+    chunk->bytes = bytes;
+    chunk->mapped = 1;
+    return chunk;
+}
+
+/*
+* Fault in the page of a candidate with a store: a page that is only read maps
+* the shared zero page, and every such candidate would alias one physical frame
+*/
+static inline void touch_line(uintptr_t addr)
+{
+    *(volatile uint8_t *)addr = 0xA5;
+}
+
+// One candidate per stride of @chunk, at the target's offset inside the stride
+static void place_candidates(uintptr_t *out, const pool_chunk_t *chunk, size_t n,
+                             size_t stride, uintptr_t base_index_bits)
+{
+    for (size_t i = 0; i < n; i++) {
+        uintptr_t addr = (uintptr_t)chunk->base + (i * stride);
+        addr = (addr & ~(stride - 1)) | base_index_bits;
+        touch_line(addr);
+        out[i] = addr;
+    }
+}
+
+address_set_t generate_candidate_set_r(void *target_addr,
+                                       size_t num_candidates,
+                                       const cache_config_t *cfg,
+                                       prng_t *rng)
+{
+    size_t l2_size = cfg->l2_size;
+    size_t num_sets = l2_size / (cfg->cache_line_size * cfg->associativity);
+    size_t stride = num_sets * cfg->cache_line_size;
+
+    pool_chunk_t *chunk = alloc_pool_chunk(stride, num_candidates * stride);
 
     uintptr_t base = (uintptr_t)target_addr;
     uintptr_t base_index_bits = base & (stride - 1);
 
     address_set_t set = create_address_set(num_candidates);
-    set.backing = pool;
+    set.backing = chunk->base;
+    set.chunks = chunk;
     set.size = num_candidates;
 
-    for (size_t i = 0; i < num_candidates; i++) {
-        uintptr_t addr = (uintptr_t)pool + (i * stride);
-        addr = (addr & ~(stride - 1)) | base_index_bits;
-        set.addresses[i] = addr;
-    }
+    place_candidates(set.addresses, chunk, num_candidates, stride, base_index_bits);
 
     // Shuffle candidates
-    for (size_t i = num_candidates - 1; i > 0; i--) {
-        size_t j = rand() % (i + 1);
-        uintptr_t tmp = set.addresses[i];
-        set.addresses[i] = set.addresses[j];
-        set.addresses[j] = tmp;
+    shuffle_addresses(set.addresses, num_candidates, rng);
+
+    if (reduction_verbose)
+        printf("[CandidateGen] %zu candidates generated for target %p (stride=%zu bytes)\n",
+               num_candidates, target_addr, stride);
+
+    return set;
+}
+
+void grow_candidate_set(address_set_t *set, void *target_addr, size_t extra,
+                        const cache_config_t *cfg, prng_t *rng)
+{
+    if (extra == 0) return;
+
+    size_t num_sets = cfg->l2_size / (cfg->cache_line_size * cfg->associativity);
+    size_t stride = num_sets * cfg->cache_line_size;
+    uintptr_t base_index_bits = (uintptr_t)target_addr & (stride - 1);
+
+    if (set->size + extra > set->capacity) {
+        size_t capacity = set->capacity * 2;
+        if (capacity < set->size + extra) capacity = set->size + extra;
+        uintptr_t *addresses = realloc(set->addresses, capacity * sizeof(uintptr_t));
+        if (!addresses) {
+            perror("realloc candidate set");
+            exit(1);
+        }
+        set->addresses = addresses;
+        set->capacity = capacity;
+    }
+
+    pool_chunk_t *chunk = alloc_pool_chunk(stride, extra * stride);
+
+    // Append the chunk: backing stays the first one
+    pool_chunk_t **tail = &set->chunks;
+    while (*tail) tail = &(*tail)->next;
+    *tail = chunk;
+    if (!set->backing) set->backing = chunk->base;
+
+    uintptr_t *added = set->addresses + set->size;
+    place_candidates(added, chunk, extra, stride, base_index_bits);
+    shuffle_addresses(added, extra, rng);
+    set->size += extra;
+
+    if (reduction_verbose)
+        printf("[CandidateGen] pool grown by %zu to %zu candidates\n", extra, set->size);
+}
+
+// ---- Huge-page candidates ----
+
+// Bytes of THP backing reported by /proc/self/smaps for the mapping at @base
+static size_t anon_huge_bytes(uintptr_t base)
+{
+    FILE *f = fopen("/proc/self/smaps", "r");
+    if (!f) return 0;
+
+    char line[256];
+    int in_range = 0;
+    size_t kb = 0;
+    while (fgets(line, sizeof(line), f)) {
+        unsigned long start, end;
+        if (sscanf(line, "%lx-%lx ", &start, &end) == 2) {
+            in_range = (base >= start && base < end);
+        } else if (in_range && sscanf(line, "AnonHugePages: %zu kB", &kb) == 1) {
+            break;
+        }
+    }
+    fclose(f);
+    return kb * 1024;
+}
+
+void *map_hugepage_region(size_t bytes, int *huge)
+{
+    bytes = (bytes + HUGE_PAGE_SIZE - 1) & ~(size_t)(HUGE_PAGE_SIZE - 1);
+    *huge = 0;
+
+    void *p = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p != MAP_FAILED) {
+        *huge = 1;
+        return p;
+    }
+
+    // No hugetlbfs pages reserved: 2 MiB-aligned reservation and ask for THP
+    size_t span = bytes + HUGE_PAGE_SIZE;
+    uint8_t *raw = mmap(NULL, span, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (raw == MAP_FAILED) {
+        perror("mmap huge page region");
+        exit(1);
+    }
+    uintptr_t base = ((uintptr_t)raw + HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1);
+    size_t head = base - (uintptr_t)raw;
+    size_t tail = span - head - bytes;
+    if (head) munmap(raw, head);
+    if (tail) munmap((uint8_t *)base + bytes, tail);
+
+#ifdef MADV_HUGEPAGE
+    madvise((void *)base, bytes, MADV_HUGEPAGE);
+#endif
+    // Fault every 2 MiB page in, THP only counts when all of them came back huge
+    for (size_t off = 0; off < bytes; off += HUGE_PAGE_SIZE)
+        touch_line(base + off);
+    *huge = anon_huge_bytes(base) >= bytes;
+    return (void *)base;
+}
+
+address_set_t generate_hugepage_candidate_set(void *target_addr,
+                                              size_t num_candidates,
+                                              int target_huge,
+                                              const cache_config_t *cfg,
+                                              prng_t *rng)
+{
+    size_t num_sets = cfg->l2_size / (cfg->cache_line_size * cfg->associativity);
+    size_t stride = num_sets * cfg->cache_line_size;
+    size_t page = cfg->page_size;
+
+    pool_chunk_t *chunk = malloc(sizeof(pool_chunk_t));
+    if (!chunk) {
+        perror("malloc pool chunk");
+        exit(1);
+    }
+
+    int huge;
+    size_t bytes = (num_candidates * stride + HUGE_PAGE_SIZE - 1) & ~(size_t)(HUGE_PAGE_SIZE - 1);
+    chunk->next = NULL;
+    chunk->base = map_hugepage_region(bytes, &huge);
+    chunk->bytes = bytes;
+    chunk->mapped = 1;
+
+    /*
+    * Set-index bits known to be physical: all of them inside a huge page
+    * (when the stride fits in one), only the page offset otherwise. Every
+    * unknown bit combination of the target is a color that gets its own
+    * num_candidates candidates.
+    */
+    size_t known = (huge && stride <= HUGE_PAGE_SIZE) ? stride : page;
+    if (!target_huge && known > page) known = page;
+    size_t colors = stride > known ? stride / known : 1;
+    uintptr_t known_bits = (uintptr_t)target_addr & (known - 1);
+
+    address_set_t set = create_address_set(num_candidates * colors);
+    set.backing = chunk->base;
+    set.chunks = chunk;
+
+    for (size_t c = 0; c < colors; c++) {
+        for (size_t i = 0; i < num_candidates; i++) {
+            uintptr_t addr = (uintptr_t)chunk->base + i * stride + c * known + known_bits;
+            touch_line(addr);
+            set.addresses[set.size++] = addr;
+        }
     }
 
-    printf("[CandidateGen] %zu candidates generated for target %p (stride=%zu bytes)\n",
-           num_candidates, target_addr, stride);
+    shuffle_addresses(set.addresses, set.size, rng);
+
+    if (reduction_verbose)
+        printf("[CandidateGen] %zu candidates in %s pages (%zu color%s x %zu)\n",
+               set.size, huge ? "2 MiB" : "4 KiB (no huge pages available)",
+               colors, colors == 1 ? "" : "s", num_candidates);
 
     return set;
 }
+
+// ---- Page-stride candidates: one line at page offset 0 of every page ----
+// Covers every page color, used to map all sets of the cache from one pool
+address_set_t generate_page_candidate_set(size_t num_candidates,
+                                          const cache_config_t *cfg)
+{
+    size_t page = cfg->page_size;
+    pool_chunk_t *chunk = alloc_pool_chunk(page, num_candidates * page);
+
+    address_set_t set = create_address_set(num_candidates);
+    set.backing = chunk->base;
+    set.chunks = chunk;
+    set.size = num_candidates;
+
+    place_candidates(set.addresses, chunk, num_candidates, page, 0);
+
+    shuffle_addresses(set.addresses, num_candidates, NULL);
+
+    if (reduction_verbose)
+        printf("[CandidateGen] %zu page-stride candidates generated (page=%zu bytes)\n",
+               num_candidates, page);
+
+    return set;
+}
+
+// ---- Retarget a stride pool: same lines of the pool, target's offset inside the stride ----
+void retarget_candidate_set(address_set_t *set, void *target_addr,
+                            const cache_config_t *cfg)
+{
+    size_t num_sets = cfg->l2_size / (cfg->cache_line_size * cfg->associativity);
+    size_t stride = num_sets * cfg->cache_line_size;
+    uintptr_t base_index_bits = (uintptr_t)target_addr & (stride - 1);
+
+    for (size_t i = 0; i < set->size; i++) {
+        set->addresses[i] = (set->addresses[i] & ~(uintptr_t)(stride - 1)) | base_index_bits;
+        touch_line(set->addresses[i]);
+    }
+}
@@ -3,12 +3,69 @@
 
 
 #include "threshold_group_testing.h"  
+#include "prng.h"
 
 eviction_test_func_t create_eviction_tester(void);
+batch_eviction_test_func_t create_batch_eviction_tester(void);
+
+// Software cache-model oracle, expects a cache_model_t* in context->oracle_state
+eviction_test_func_t create_cache_model_tester(void);
+batch_eviction_test_func_t create_cache_model_batch_tester(void);
+
+// Reload-latency oracle, expects a cache_timing_t* in context->calibration_data (see setup_cache_timing())
+eviction_test_func_t create_timing_tester(void);
+batch_eviction_test_func_t create_timing_batch_tester(void);
 
 
 address_set_t generate_candidate_set(void *target_addr,
                                      size_t num_candidates,
                                      const cache_config_t *cfg);
-                                     
+
+// Same as generate_candidate_set(), shuffled from @rng instead of rand()
+address_set_t generate_candidate_set_r(void *target_addr,
+                                       size_t num_candidates,
+                                       const cache_config_t *cfg,
+                                       prng_t *rng);
+
+/*
+* Append @extra candidates for @target_addr in a new chunk of pool memory
+* The candidates already placed keep their memory and their order, only the
+* new ones are initialised and shuffled (from rand() when @rng is NULL)
+*/
+void grow_candidate_set(address_set_t *set, void *target_addr, size_t extra,
+                        const cache_config_t *cfg, prng_t *rng);
+
+/*
+* Point every candidate of a generate_candidate_set() pool at the set of @target_addr,
+* reusing the pool memory: only the offset inside each stride changes
+*/
+void retarget_candidate_set(address_set_t *set, void *target_addr,
+                            const cache_config_t *cfg);
+
+#define HUGE_PAGE_SIZE (2ul * 1024 * 1024)
+
+/*
+* Anonymous 2 MiB-aligned region of @bytes (rounded up to 2 MiB), from
+* MAP_HUGETLB or else transparent huge pages via madvise(MADV_HUGEPAGE)
+* @huge: Set to 1 when the whole region is known to be backed by huge pages
+* Release with munmap() of the rounded size
+*/
+void *map_hugepage_region(size_t bytes, int *huge);
+
+/*
+* Candidates from huge pages, where the virtual set-index bits are the physical ones
+* @num_candidates: Per color. With the pool and the target (@target_huge) in huge
+*                  pages every candidate is congruent with the target; otherwise
+*                  each page color the target could have gets its own candidates
+*/
+address_set_t generate_hugepage_candidate_set(void *target_addr,
+                                              size_t num_candidates,
+                                              int target_huge,
+                                              const cache_config_t *cfg,
+                                              prng_t *rng);
+
+// One candidate at page offset 0 of each of @num_candidates pages, shuffled
+address_set_t generate_page_candidate_set(size_t num_candidates,
+                                          const cache_config_t *cfg);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include "binary_search_reduction.h"
+#include "evlist.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/*
+* Smallest len in [lo, hi] such that W[0..k+len) evicts, W[0..k+hi) is assumed to
+* In chase mode W[0..k+hi) must be linked, a prefix is the chain cut after its last line
+*/
+static size_t evicting_prefix_len(uintptr_t *W, size_t k, size_t lo, size_t hi,
+                                  eviction_test_func_t test_func,
+                                  const test_context_t *context)
+{
+    int chase = (context->traversal == TRAVERSE_CHASE);
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        address_set_t prefix = address_set_view(W, k + mid);
+        uintptr_t last = W[k + mid - 1];
+        uintptr_t cut = 0;
+        if (chase) {
+            prefix.addresses = NULL;
+            prefix.chain = W[0];
+            cut = evlist_next(last);
+            evlist_set_next(last, 0);
+        }
+
+        int evicts = test_func(&prefix, context);
+        if (chase) evlist_set_next(last, cut);
+
+        if (evicts)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    return lo;
+}
+
+/*
+* Working array layout: W[0..k) congruent addresses found so far,
+* W[k..m) the pool left to search. Invariant: W[0..m) evicts the target.
+*/
+address_set_t binary_search_reduction(const address_set_t *candidate_set,
+                                      const cache_config_t *config,
+                                      eviction_test_func_t test_func,
+                                      const test_context_t *context)
+{
+    size_t a = config->associativity;
+
+    address_set_t W = create_address_set(candidate_set->size);
+    memcpy(W.addresses, candidate_set->addresses, candidate_set->size * sizeof(uintptr_t));
+    W.size = candidate_set->size;
+
+    TGT_LOG("Starting binary search reduction:\n");
+    TGT_LOG("  Initial set size: %zu\n", W.size);
+    TGT_LOG("  Target associativity: %zu\n", a);
+    TGT_LOG("  Target address: 0x%lx\n", (uintptr_t)context->target_address);
+
+    size_t k = 0;
+    size_t m = W.size;
+
+    int chase = (context->traversal == TRAVERSE_CHASE);
+
+    while (k < a && m > a) {
+        if (chase) evlist_link(W.addresses, m);
+
+        // Smallest len such that W[0..k+len) still evicts
+        size_t lo = evicting_prefix_len(W.addresses, k, 1, m - k, test_func, context);
+
+        // W[k+lo-1] is needed: move it to the found region, keep the prefix before it
+        size_t found = k + lo - 1;
+        uintptr_t tmp = W.addresses[k];
+        W.addresses[k] = W.addresses[found];
+        W.addresses[found] = tmp;
+
+        k++;
+        m = k + lo - 1;
+        TGT_LOG_STEP("Found congruent address %zu/%zu (0x%lx), pool now %zu\n",
+                     k, a, W.addresses[k - 1], m - k);
+    }
+
+    // Whatever is left in the pool is needed too once only `a` addresses remain
+    if (m <= a) k = m;
+
+    address_set_t result = create_address_set(k > a ? k : a);
+    memcpy(result.addresses, W.addresses, k * sizeof(uintptr_t));
+    result.size = k;
+
+    if (k == a && test_func(&result, context)) {
+        TGT_LOG("SUCCESS: Found minimal eviction set of size %zu\n", result.size);
+    } else {
+        TGT_LOG("FAILED: Could not reduce to a verified minimal set. Current size: %zu\n", k);
+    }
+
+    free_address_set(&W);
+    return result;
+}
+
+size_t shortest_evicting_prefix(const address_set_t *candidate_set,
+                                const cache_config_t *config,
+                                eviction_test_func_t test_func,
+                                const test_context_t *context)
+{
+    size_t n = candidate_set->size;
+    size_t a = config->associativity;
+    if (n <= a) return n;
+
+    if (context->traversal == TRAVERSE_CHASE) evlist_link(candidate_set->addresses, n);
+    return evicting_prefix_len(candidate_set->addresses, 0, a, n, test_func, context);
+}
+
+address_set_t prefix_reduction(reduction_func_t reducer,
+                               const address_set_t *candidate_set,
+                               const cache_config_t *config,
+                               eviction_test_func_t test_func,
+                               const test_context_t *context)
+{
+    // binary_search_reduction() opens with this same search, a pre-stage would repeat it
+    if (reducer == binary_search_reduction)
+        return reducer(candidate_set, config, test_func, context);
+
+    size_t len = shortest_evicting_prefix(candidate_set, config, test_func, context);
+    TGT_LOG("Shortest evicting prefix: %zu of %zu candidates\n", len, candidate_set->size);
+    if (len == candidate_set->size) return reducer(candidate_set, config, test_func, context);
+
+    address_set_t prefix = address_set_view(candidate_set->addresses, len);
+    address_set_t result = reducer(&prefix, config, test_func, context);
+
+    // A wrong "evicts" answer can cut the prefix short, the whole pool is the fallback
+    if (result.size != config->associativity) {
+        TGT_LOG("Reduction of the prefix failed, retrying on the whole pool\n");
+        free_address_set(&result);
+        result = reducer(candidate_set, config, test_func, context);
+    }
+    return result;
+}
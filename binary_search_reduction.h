@@ -0,0 +1,38 @@
+#ifndef BINARY_SEARCH_REDUCTION_H
+#define BINARY_SEARCH_REDUCTION_H
+
+#include "threshold_group_testing.h"
+
+/*
+* Element-wise reduction: each congruent address is found as the last element of
+* the shortest evicting prefix of the pool, then the search repeats on that prefix.
+* Same contract as threshold_group_reduction(), so both can sit behind a reduction_func_t.
+*/
+address_set_t binary_search_reduction(const address_set_t *candidate_set,
+                                      const cache_config_t *config,
+                                      eviction_test_func_t test_func,
+                                      const test_context_t *context);
+
+/*
+* Length of the shortest prefix of @candidate_set that still evicts, found by
+* binary search between associativity and the size of the (evicting) set.
+* The pool must be shuffled: a prefix then holds its share of congruent lines.
+*/
+size_t shortest_evicting_prefix(const address_set_t *candidate_set,
+                                const cache_config_t *config,
+                                eviction_test_func_t test_func,
+                                const test_context_t *context);
+
+/*
+* Pre-reduction: run @reducer on the shortest evicting prefix of @candidate_set
+* only, so that its first rounds no longer traverse the surplus of a doubled pool.
+* Falls back to the whole pool when the prefix does not reduce to `associativity`.
+* binary_search_reduction() already starts with this search and gets the whole pool.
+*/
+address_set_t prefix_reduction(reduction_func_t reducer,
+                               const address_set_t *candidate_set,
+                               const cache_config_t *config,
+                               eviction_test_func_t test_func,
+                               const test_context_t *context);
+
+#endif //BINARY_SEARCH_REDUCTION_H
@@ -0,0 +1,147 @@
+#include "cache_hierarchy.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+cache_hierarchy_t cache_hierarchy_default(void)
+{
+    cache_hierarchy_t hier;
+    memset(&hier, 0, sizeof(hier));
+    hier.num_levels = 2;
+    hier.levels[0] = (cache_level_t){ .size = 32 * 1024, .associativity = 8,
+                                      .line_size = 64, .slices = 1, .inclusive = 0 };
+    hier.levels[1] = (cache_level_t){ .size = 256 * 1024, .associativity = 8,
+                                      .line_size = 64, .slices = 1, .inclusive = 0 };
+    return hier;
+}
+
+static size_t parse_size(const char *s, char **end)
+{
+    size_t v = (size_t)strtoul(s, end, 0);
+    if (**end == 'K' || **end == 'k') {
+        v *= 1024;
+        (*end)++;
+    } else if (**end == 'M' || **end == 'm') {
+        v *= 1024 * 1024;
+        (*end)++;
+    }
+    return v;
+}
+
+int parse_cache_hierarchy(const char *spec, cache_hierarchy_t *out)
+{
+    cache_hierarchy_t hier;
+    memset(&hier, 0, sizeof(hier));
+
+    char *copy = strdup(spec);
+    int ok = 1;
+    char *save_level = NULL;
+    for (char *lvl = strtok_r(copy, ",", &save_level); lvl && ok;
+         lvl = strtok_r(NULL, ",", &save_level)) {
+        if (hier.num_levels == MAX_CACHE_LEVELS) {
+            ok = 0;
+            break;
+        }
+        cache_level_t *l = &hier.levels[hier.num_levels++];
+        l->line_size = 64;
+        l->slices = 1;
+
+        char *save_field = NULL, *end;
+        int field = 0;
+        for (char *f = strtok_r(lvl, "/", &save_field); f; f = strtok_r(NULL, "/", &save_field), field++) {
+            if (field == 0) {
+                l->size = parse_size(f, &end);
+            } else if (field == 1) {
+                l->associativity = (size_t)strtoul(f, &end, 0);
+            } else if (strcmp(f, "i") == 0) {
+                l->inclusive = 1;
+                continue;
+            } else if (f[0] == 's') {
+                l->slices = (size_t)strtoul(f + 1, &end, 0);
+            } else {
+                l->line_size = (size_t)strtoul(f, &end, 0);
+            }
+            if (*end != '\0') ok = 0;
+        }
+        if (!l->size || !l->associativity || !l->line_size || !l->slices ||
+            l->size % (l->associativity * l->line_size * l->slices) != 0)
+            ok = 0;
+    }
+    free(copy);
+
+    if (!ok || hier.num_levels == 0) return 0;
+    *out = hier;
+    return 1;
+}
+
+static int read_sysfs_value(const char *dir, const char *name, char *buf, size_t len)
+{
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE *f = fopen(path, "r");
+    if (!f) return 0;
+    int ok = fgets(buf, (int)len, f) != NULL;
+    fclose(f);
+    if (ok) buf[strcspn(buf, "\n")] = '\0';
+    return ok;
+}
+
+int cache_hierarchy_from_sysfs(cache_hierarchy_t *out)
+{
+    cache_hierarchy_t hier;
+    memset(&hier, 0, sizeof(hier));
+
+    for (int index = 0; index < 16; index++) {
+        char dir[128], buf[64];
+        snprintf(dir, sizeof(dir), "/sys/devices/system/cpu/cpu0/cache/index%d", index);
+        if (!read_sysfs_value(dir, "type", buf, sizeof(buf))) break;
+        if (strcmp(buf, "Instruction") == 0) continue;
+
+        if (!read_sysfs_value(dir, "level", buf, sizeof(buf))) return 0;
+        int level = atoi(buf);
+        if (level < 1 || level > MAX_CACHE_LEVELS) continue;
+
+        cache_level_t *l = &hier.levels[level - 1];
+        char *end;
+        if (!read_sysfs_value(dir, "size", buf, sizeof(buf))) return 0;
+        l->size = parse_size(buf, &end);
+        if (!read_sysfs_value(dir, "ways_of_associativity", buf, sizeof(buf))) return 0;
+        l->associativity = (size_t)strtoul(buf, NULL, 0);
+        if (!read_sysfs_value(dir, "coherency_line_size", buf, sizeof(buf))) return 0;
+        l->line_size = (size_t)strtoul(buf, NULL, 0);
+        // Slice count and inclusivity are not exported, see parse_cache_hierarchy()
+        l->slices = 1;
+        if ((size_t)level > hier.num_levels) hier.num_levels = (size_t)level;
+    }
+
+    for (size_t i = 0; i < hier.num_levels; i++) {
+        if (!hier.levels[i].size || !hier.levels[i].associativity) return 0;
+    }
+    if (hier.num_levels == 0) return 0;
+    *out = hier;
+    return 1;
+}
+
+cache_config_t cache_level_config(const cache_hierarchy_t *hier, int level, size_t page_size)
+{
+    const cache_level_t *l = &hier->levels[level - 1];
+    cache_config_t cfg = {
+        .associativity   = l->associativity,
+        .cache_line_size = l->line_size,
+        .page_size       = page_size,
+        .l2_size         = l->size / l->slices
+    };
+    return cfg;
+}
+
+void print_cache_hierarchy(const cache_hierarchy_t *hier)
+{
+    for (size_t i = 0; i < hier->num_levels; i++) {
+        const cache_level_t *l = &hier->levels[i];
+        size_t sets = l->size / (l->associativity * l->line_size * l->slices);
+        printf("  L%zu: %zu KiB, %zu-way, %zu B lines, %zu sets x %zu slice%s%s\n",
+               i + 1, l->size / 1024, l->associativity, l->line_size, sets,
+               l->slices, l->slices == 1 ? "" : "s", l->inclusive ? ", inclusive" : "");
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef CACHE_HIERARCHY_H
+#define CACHE_HIERARCHY_H
+
+#include <stddef.h>
+
+#include "threshold_group_testing.h"
+
+#define MAX_CACHE_LEVELS 4
+
+typedef struct {
+    size_t size;            // bytes, all slices together
+    size_t associativity;
+    size_t line_size;
+    size_t slices;          // 1 when the level is not sliced
+    int inclusive;          // holds every line cached by the levels above it
+} cache_level_t;
+
+/*
+* Data-side cache hierarchy, levels[0] is L1.
+* Level numbers follow m5_get_last_hit_level(): level N hits report N,
+* anything that misses every level reports num_levels + 1.
+*/
+typedef struct {
+    size_t num_levels;
+    cache_level_t levels[MAX_CACHE_LEVELS];
+} cache_hierarchy_t;
+
+
+// 32 KiB 8-way L1D and 256 KiB 8-way L2 with 64-byte lines, the gem5 setup the tools assume
+cache_hierarchy_t cache_hierarchy_default(void);
+
+/*
+* Parse "size/ways[/line][/i][/sN],..." from L1 down, sizes take K/M suffixes
+* e.g. "32K/8,256K/8,8M/16/i/s4": inclusive 8 MiB LLC in 4 slices
+* Returns 1 on success, 0 on a malformed spec
+*/
+int parse_cache_hierarchy(const char *spec, cache_hierarchy_t *out);
+
+/*
+* Data and unified caches of cpu0 from /sys/devices/system/cpu/cpu0/cache
+* Returns 1 on success, 0 when sysfs does not describe the caches
+*/
+int cache_hierarchy_from_sysfs(cache_hierarchy_t *out);
+
+/*
+* Geometry of one slice of level @level (1-based) in the form the candidate
+* generator, the reducers and the cache model take: l2_size is the size of
+* the level per slice, whatever the level is
+*/
+cache_config_t cache_level_config(const cache_hierarchy_t *hier, int level, size_t page_size);
+
+void print_cache_hierarchy(const cache_hierarchy_t *hier);
+
+#endif //CACHE_HIERARCHY_H
@@ -0,0 +1,265 @@
+#include "cache_model.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RRPV_MAX    3
+#define RRPV_INSERT 2
+
+static uint64_t xorshift64(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+static int is_power_of_two(size_t x) {
+    return x && !(x & (x - 1));
+}
+
+static void alloc_state(cache_model_t *model)
+{
+    size_t n = model->num_sets * model->slices * model->ways;
+    model->tags  = calloc(n, sizeof(uintptr_t));
+    model->stamp = calloc(n, sizeof(uint64_t));
+    model->plru  = calloc(n, sizeof(uint8_t));
+    model->rrpv  = calloc(n, sizeof(uint8_t));
+    if (!model->tags || !model->stamp || !model->plru || !model->rrpv) {
+        perror("calloc cache model state");
+        exit(1);
+    }
+}
+
+cache_model_t *cache_model_create(const cache_config_t *cfg,
+                                  replacement_policy_t policy,
+                                  uint64_t seed)
+{
+    size_t ways = cfg->associativity;
+    size_t num_sets = cfg->l2_size / (cfg->cache_line_size * ways);
+
+    if (ways == 0 || num_sets == 0) {
+        fprintf(stderr, "[CacheModel] invalid geometry (size=%zu, ways=%zu)\n",
+                cfg->l2_size, ways);
+        return NULL;
+    }
+    if (policy == REPL_PLRU && !is_power_of_two(ways)) {
+        fprintf(stderr, "[CacheModel] tree-PLRU needs a power-of-two associativity (got %zu)\n",
+                ways);
+        return NULL;
+    }
+
+    cache_model_t *model = calloc(1, sizeof(*model));
+    if (!model) {
+        perror("calloc cache_model_t");
+        exit(1);
+    }
+
+    model->num_sets  = num_sets;
+    model->slices    = 1;
+    model->ways      = ways;
+    model->line_size = cfg->cache_line_size;
+    model->policy    = policy;
+    model->rng       = seed ? seed : 0x9E3779B97F4A7C15ull;
+
+    alloc_state(model);
+    cache_model_flush(model);
+    return model;
+}
+
+void cache_model_set_slice_hash(cache_model_t *model, const slice_hash_t *hash)
+{
+    free(model->tags);
+    free(model->stamp);
+    free(model->plru);
+    free(model->rrpv);
+
+    model->slice_hash = *hash;
+    model->slices = (size_t)1 << hash->num_bits;
+    alloc_state(model);
+    cache_model_flush(model);
+}
+
+void cache_model_destroy(cache_model_t *model)
+{
+    if (!model) return;
+    free(model->tags);
+    free(model->stamp);
+    free(model->plru);
+    free(model->rrpv);
+    free(model);
+}
+
+void cache_model_flush(cache_model_t *model)
+{
+    size_t n = model->num_sets * model->slices * model->ways;
+    memset(model->tags, 0, n * sizeof(uintptr_t));
+    memset(model->stamp, 0, n * sizeof(uint64_t));
+    memset(model->plru, 0, n * sizeof(uint8_t));
+    memset(model->rrpv, RRPV_MAX, n * sizeof(uint8_t));
+    model->clock  = 0;
+    model->hits   = 0;
+    model->misses = 0;
+}
+
+size_t cache_model_set_index(const cache_model_t *model, uintptr_t addr)
+{
+    size_t set = (addr / model->line_size) % model->num_sets;
+    if (model->slices > 1) set += slice_of(&model->slice_hash, addr) * model->num_sets;
+    return set;
+}
+
+static uintptr_t line_tag(const cache_model_t *model, uintptr_t addr)
+{
+    // +1 so that a zero tag always means an invalid way
+    return addr / model->line_size + 1;
+}
+
+static long find_way(const cache_model_t *model, size_t set, uintptr_t tag)
+{
+    const uintptr_t *tags = &model->tags[set * model->ways];
+    for (size_t w = 0; w < model->ways; w++) {
+        if (tags[w] == tag) return (long)w;
+    }
+    return -1;
+}
+
+/*
+* Tree-PLRU: node bits point towards the pseudo-LRU half.
+* On a touch, every node on the path is flipped to point away from @way.
+*/
+static void plru_touch(cache_model_t *model, size_t set, size_t way)
+{
+    uint8_t *bits = &model->plru[set * model->ways];
+    size_t node = 0;
+    size_t lo = 0, hi = model->ways;
+
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (way < mid) {
+            bits[node] = 1;         // LRU side is now the upper half
+            node = 2 * node + 1;
+            hi = mid;
+        } else {
+            bits[node] = 0;
+            node = 2 * node + 2;
+            lo = mid;
+        }
+    }
+}
+
+static size_t plru_victim(const cache_model_t *model, size_t set)
+{
+    const uint8_t *bits = &model->plru[set * model->ways];
+    size_t node = 0;
+    size_t lo = 0, hi = model->ways;
+
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (bits[node]) {
+            node = 2 * node + 2;
+            lo = mid;
+        } else {
+            node = 2 * node + 1;
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static size_t rrip_victim(cache_model_t *model, size_t set)
+{
+    uint8_t *rrpv = &model->rrpv[set * model->ways];
+    for (;;) {
+        for (size_t w = 0; w < model->ways; w++) {
+            if (rrpv[w] >= RRPV_MAX) return w;
+        }
+        for (size_t w = 0; w < model->ways; w++) rrpv[w]++;
+    }
+}
+
+static size_t choose_victim(cache_model_t *model, size_t set)
+{
+    uintptr_t *tags = &model->tags[set * model->ways];
+
+    // Fill invalid ways first, whatever the policy
+    for (size_t w = 0; w < model->ways; w++) {
+        if (tags[w] == 0) return w;
+    }
+
+    switch (model->policy) {
+    case REPL_PLRU:
+        return plru_victim(model, set);
+    case REPL_RANDOM:
+        return xorshift64(&model->rng) % model->ways;
+    case REPL_RRIP:
+        return rrip_victim(model, set);
+    case REPL_LRU:
+    default: {
+        const uint64_t *stamp = &model->stamp[set * model->ways];
+        size_t victim = 0;
+        for (size_t w = 1; w < model->ways; w++) {
+            if (stamp[w] < stamp[victim]) victim = w;
+        }
+        return victim;
+    }
+    }
+}
+
+static void touch(cache_model_t *model, size_t set, size_t way, int hit)
+{
+    size_t idx = set * model->ways + way;
+
+    model->stamp[idx] = ++model->clock;
+    if (model->policy == REPL_PLRU) plru_touch(model, set, way);
+    if (model->policy == REPL_RRIP) model->rrpv[idx] = hit ? 0 : RRPV_INSERT;
+}
+
+int cache_model_access(cache_model_t *model, uintptr_t addr)
+{
+    size_t set = cache_model_set_index(model, addr);
+    uintptr_t tag = line_tag(model, addr);
+
+    long way = find_way(model, set, tag);
+    if (way >= 0) {
+        touch(model, set, (size_t)way, 1);
+        model->hits++;
+        return 1;
+    }
+
+    size_t victim = choose_victim(model, set);
+    model->tags[set * model->ways + victim] = tag;
+    touch(model, set, victim, 0);
+    model->misses++;
+    return 0;
+}
+
+int cache_model_contains(const cache_model_t *model, uintptr_t addr)
+{
+    return find_way(model, cache_model_set_index(model, addr), line_tag(model, addr)) >= 0;
+}
+
+const char *replacement_policy_name(replacement_policy_t policy)
+{
+    switch (policy) {
+    case REPL_LRU:    return "lru";
+    case REPL_PLRU:   return "plru";
+    case REPL_RANDOM: return "random";
+    case REPL_RRIP:   return "rrip";
+    }
+    return "unknown";
+}
+
+int parse_replacement_policy(const char *name, replacement_policy_t *out)
+{
+    static const replacement_policy_t all[] = { REPL_LRU, REPL_PLRU, REPL_RANDOM, REPL_RRIP };
+    for (size_t i = 0; i < sizeof(all) / sizeof(all[0]); i++) {
+        if (strcmp(name, replacement_policy_name(all[i])) == 0) {
+            *out = all[i];
+            return 1;
+        }
+    }
+    return 0;
+}
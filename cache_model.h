@@ -0,0 +1,74 @@
+#ifndef CACHE_MODEL_H
+#define CACHE_MODEL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "threshold_group_testing.h"
+#include "slice_hash.h"
+
+typedef enum {
+    REPL_LRU = 0,
+    REPL_PLRU,      // tree pseudo-LRU, needs a power-of-two associativity
+    REPL_RANDOM,
+    REPL_RRIP       // static RRIP with 2-bit re-reference prediction values
+} replacement_policy_t;
+
+/*
+* Software model of a single set-associative cache level.
+* Only tags are tracked, no data: an access never touches the address itself.
+*/
+typedef struct {
+    size_t num_sets;    // per slice
+    size_t slices;      // 1 unless cache_model_set_slice_hash() was called
+    slice_hash_t slice_hash;
+    size_t ways;
+    size_t line_size;
+    replacement_policy_t policy;
+
+    uintptr_t *tags;    // num_sets * ways line numbers, 0 = invalid way
+    uint64_t *stamp;    // LRU: last-use timestamp per way
+    uint8_t *plru;      // PLRU: (ways - 1) tree bits per set
+    uint8_t *rrpv;      // RRIP: re-reference prediction value per way
+
+    uint64_t clock;
+    uint64_t rng;
+
+    uint64_t hits;
+    uint64_t misses;
+} cache_model_t;
+
+
+/*
+* Create a model of the cache described by @cfg (l2_size / associativity / line size)
+* @policy: Replacement policy used on every set
+* @seed: Seed for the random replacement policy
+* Returns NULL if the geometry is not supported by the policy
+*/
+cache_model_t *cache_model_create(const cache_config_t *cfg,
+                                  replacement_policy_t policy,
+                                  uint64_t seed);
+void cache_model_destroy(cache_model_t *model);
+
+// Invalidate every line and reset the hit/miss counters
+void cache_model_flush(cache_model_t *model);
+
+// Access one address, returns 1 on hit and 0 on miss (the line is filled on a miss)
+int cache_model_access(cache_model_t *model, uintptr_t addr);
+
+// Lookup without updating the replacement state
+int cache_model_contains(const cache_model_t *model, uintptr_t addr);
+
+/*
+* Split the model into slices selected by @hash over the (virtual = physical) address
+* Each slice keeps the geometry the model was created with; the state is flushed
+*/
+void cache_model_set_slice_hash(cache_model_t *model, const slice_hash_t *hash);
+
+// Set number across all slices: slice * num_sets + set index inside the slice
+size_t cache_model_set_index(const cache_model_t *model, uintptr_t addr);
+
+const char *replacement_policy_name(replacement_policy_t policy);
+int parse_replacement_policy(const char *name, replacement_policy_t *out);
+
+#endif //CACHE_MODEL_H
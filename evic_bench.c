@@ -0,0 +1,292 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "threshold_group_testing.h"
+#include "address_set_adapter.h"
+#include "cache_model.h"
+#include "oracle_stats.h"
+#include "binary_search_reduction.h"
+#include "static_group_reduction.h"
+#include "voting_oracle.h"
+#include "traversal.h"
+
+/*
+* Reduction cost benchmark against the software cache model.
+* Sweeps seeds x associativity x pool size x replacement policy and reports
+* the distribution of oracle calls and candidate loads per reduction.
+* Only one candidate in `congruence` maps to the target's set, at positions
+* that depend on the seed (see spread_candidates()).
+*/
+
+#define MAX_LIST 16
+
+typedef struct {
+    uint64_t *calls;
+    uint64_t *loads;
+    size_t runs;
+    size_t no_evict;   // pool did not evict, no reduction run
+    size_t success;    // reduced to a congruent set of exactly `associativity` lines
+} bench_result_t;
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of a sorted sample
+static uint64_t percentile(const uint64_t *sorted, size_t n, double p)
+{
+    if (n == 0) return 0;
+    size_t rank = (size_t)(p * (double)n + 0.999999);
+    if (rank == 0) rank = 1;
+    if (rank > n) rank = n;
+    return sorted[rank - 1];
+}
+
+static size_t parse_list(const char *arg, size_t *out)
+{
+    size_t n = 0;
+    char *copy = strdup(arg);
+    for (char *tok = strtok(copy, ","); tok && n < MAX_LIST; tok = strtok(NULL, ",")) {
+        out[n++] = (size_t)strtoul(tok, NULL, 0);
+    }
+    free(copy);
+    return n;
+}
+
+static int is_congruent_set(const address_set_t *set, const cache_model_t *model,
+                            uintptr_t target, size_t associativity)
+{
+    if (set->size != associativity) return 0;
+    size_t target_set = cache_model_set_index(model, target);
+    for (size_t i = 0; i < set->size; i++) {
+        if (cache_model_set_index(model, set->addresses[i]) != target_set) return 0;
+    }
+    return 1;
+}
+
+/*
+* Keep the candidate of every congruence-th stride slot on the target's set and move
+* the one of slot i by (i % congruence) / congruence of the set stride, inside its slot.
+* Which pool slots stay congruent then depends on the seeded shuffle only, not on
+* where the pool was mapped.
+*/
+static void spread_candidates(address_set_t *pool, const cache_config_t *cfg, size_t congruence)
+{
+    size_t stride = cfg->l2_size / cfg->associativity;
+    size_t step = stride / congruence;
+    uintptr_t base = (uintptr_t)pool->backing;
+
+    for (size_t j = 0; j < pool->size; j++) {
+        uintptr_t addr = pool->addresses[j];
+        size_t slot = (addr - base) / stride;
+        uintptr_t offset = (addr + (slot % congruence) * step) & (stride - 1);
+        pool->addresses[j] = (addr & ~(uintptr_t)(stride - 1)) | offset;
+    }
+}
+
+static void run_config(const cache_config_t *cfg, replacement_policy_t policy,
+                       reduction_func_t reducer, traversal_mode_t traversal,
+                       const traversal_pattern_t *pattern, int use_prefix,
+                       size_t pool_size, size_t congruence, unsigned seeds,
+                       const voting_oracle_t *vote, bench_result_t *res)
+{
+    uint8_t *target = aligned_alloc(cfg->cache_line_size, cfg->cache_line_size);
+    if (!target) {
+        perror("aligned_alloc");
+        exit(1);
+    }
+
+    for (unsigned seed = 1; seed <= seeds; seed++) {
+        srand(seed);
+
+        cache_model_t *model = cache_model_create(cfg, policy, seed);
+        if (!model) break;
+
+        oracle_stats_t stats = {0};
+        test_context_t ctx = {0};
+        ctx.target_address = target;
+        ctx.oracle_state = model;
+        ctx.stats = &stats;
+        ctx.traversal = traversal;
+        ctx.pattern = pattern;
+        eviction_test_func_t oracle = oracle_stats_wrap(&stats, create_cache_model_tester());
+
+        voting_oracle_t voting;
+        if (vote) {
+            voting = *vote;
+            oracle = voting_oracle_wrap(&voting, oracle);
+            ctx.vote = &voting;
+        }
+
+        address_set_t candidates = generate_candidate_set(target, pool_size, cfg);
+        spread_candidates(&candidates, cfg, congruence);
+        if (!oracle(&candidates, &ctx)) {
+            res->no_evict++;
+        } else {
+            oracle_stats_reset(&stats);
+            address_set_t minimal = use_prefix
+                ? prefix_reduction(reducer, &candidates, cfg, oracle, &ctx)
+                : reducer(&candidates, cfg, oracle, &ctx);
+
+            res->calls[res->runs] = stats.calls;
+            res->loads[res->runs] = stats.loads;
+            res->runs++;
+            if (is_congruent_set(&minimal, model, (uintptr_t)target, cfg->associativity))
+                res->success++;
+            free_address_set(&minimal);
+        }
+
+        free_address_set(&candidates);
+        cache_model_destroy(model);
+    }
+
+    free(target);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned seeds = 20;
+    size_t assocs[MAX_LIST] = { 4, 8, 16 };
+    size_t n_assocs = 3;
+    size_t pools[MAX_LIST] = { 256, 512, 1024 };
+    size_t n_pools = 3;
+    size_t congruence = 8;  // page-stride candidates: 512 sets of 64-byte lines over 4 KiB pages
+    replacement_policy_t policies[] = { REPL_LRU, REPL_PLRU, REPL_RANDOM, REPL_RRIP };
+    size_t n_policies = sizeof(policies) / sizeof(policies[0]);
+    size_t num_sets = 512;
+    const char *reducer_name = "tgt";
+    reduction_func_t reducer = threshold_group_reduction;
+    traversal_mode_t traversal = TRAVERSE_ARRAY;
+    int vote = 0;
+    voting_oracle_t voting;
+    traversal_pattern_t pattern = { 1, 0, TRAVERSE_FORWARD };
+    int use_pattern = 0;
+    int use_prefix = 1;
+
+    voting_oracle_init(&voting);
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--seeds") == 0 && i + 1 < argc) {
+            seeds = (unsigned)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--assoc") == 0 && i + 1 < argc) {
+            n_assocs = parse_list(argv[++i], assocs);
+        } else if (strcmp(argv[i], "--pools") == 0 && i + 1 < argc) {
+            n_pools = parse_list(argv[++i], pools);
+        } else if (strcmp(argv[i], "--sets") == 0 && i + 1 < argc) {
+            num_sets = (size_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--congruence") == 0 && i + 1 < argc) {
+            congruence = (size_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--policy") == 0 && i + 1 < argc) {
+            if (!parse_replacement_policy(argv[++i], &policies[0])) {
+                fprintf(stderr, "Unknown replacement policy: %s\n", argv[i]);
+                return 1;
+            }
+            n_policies = 1;
+        } else if (strcmp(argv[i], "--reducer") == 0 && i + 1 < argc) {
+            reducer_name = argv[++i];
+            if (strcmp(reducer_name, "tgt") == 0) {
+                reducer = threshold_group_reduction;
+            } else if (strcmp(reducer_name, "tgt-static") == 0) {
+                reducer = static_group_reduction;
+            } else if (strcmp(reducer_name, "bs") == 0) {
+                reducer = binary_search_reduction;
+            } else {
+                fprintf(stderr, "Unknown reducer: %s\n", reducer_name);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--chase") == 0) {
+            traversal = TRAVERSE_CHASE;
+        } else if (strcmp(argv[i], "--pattern") == 0 && i + 1 < argc) {
+            if (!parse_traversal_pattern(argv[++i], &pattern)) {
+                fprintf(stderr, "Bad traversal pattern: %s\n", argv[i]);
+                return 1;
+            }
+            use_pattern = 1;
+        } else if (strcmp(argv[i], "--no-prefix") == 0) {
+            use_prefix = 0;
+        } else if (strcmp(argv[i], "--vote") == 0) {
+            vote = 1;
+        } else if (strcmp(argv[i], "--vote-alpha") == 0 && i + 1 < argc) {
+            vote = 1;
+            voting.alpha = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--vote-beta") == 0 && i + 1 < argc) {
+            vote = 1;
+            voting.beta = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--help") == 0) {
+            printf("Usage: %s [--seeds <N>] [--assoc <a,b,..>] [--pools <n,m,..>]"
+                   " [--sets <S>] [--congruence <k>] [--policy lru|plru|random|rrip] [--reducer tgt|tgt-static|bs] [--chase]"
+                   " [--vote] [--vote-alpha <A>] [--vote-beta <B>]"
+                   " [--pattern <r:w:dir>] [--no-prefix]\n", argv[0]);
+            return 0;
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    // The spread step is a fraction of the set stride
+    if (!congruence || (congruence & (congruence - 1)) || congruence > num_sets) {
+        fprintf(stderr, "--congruence must be a power of two no larger than --sets\n");
+        return 1;
+    }
+
+    reduction_verbose = 0;
+    voting_oracle_configure(&voting);
+
+    bench_result_t res;
+    res.calls = malloc(seeds * sizeof(uint64_t));
+    res.loads = malloc(seeds * sizeof(uint64_t));
+    if (!res.calls || !res.loads) {
+        perror("malloc");
+        return 1;
+    }
+
+    char pattern_name[32] = "1:0:fwd";
+    if (use_pattern) format_traversal_pattern(&pattern, pattern_name, sizeof(pattern_name));
+    printf("reducer: %s%s, traversal: %s %s, 1 in %zu candidates congruent\n", reducer_name,
+           use_prefix ? " on the shortest evicting prefix" : "",
+           traversal == TRAVERSE_CHASE ? "pointer chase" : "array", pattern_name, congruence);
+    if (vote) printf("voting oracle: alpha=%g, beta=%g\n", voting.alpha, voting.beta);
+    printf("%-7s %5s %6s %5s %7s %8s %8s %10s %10s\n",
+           "policy", "assoc", "pool", "runs", "success",
+           "calls50", "calls95", "loads50", "loads95");
+
+    for (size_t p = 0; p < n_policies; p++) {
+        for (size_t a = 0; a < n_assocs; a++) {
+            cache_config_t cfg = {
+                .associativity   = assocs[a],
+                .cache_line_size = 64,
+                .page_size       = 4096,
+                .l2_size         = num_sets * 64 * assocs[a]
+            };
+
+            for (size_t n = 0; n < n_pools; n++) {
+                res.runs = res.no_evict = res.success = 0;
+                run_config(&cfg, policies[p], reducer, traversal, use_pattern ? &pattern : NULL, use_prefix,
+                           pools[n], congruence, seeds, vote ? &voting : NULL, &res);
+
+                qsort(res.calls, res.runs, sizeof(uint64_t), cmp_u64);
+                qsort(res.loads, res.runs, sizeof(uint64_t), cmp_u64);
+
+                printf("%-7s %5zu %6zu %5zu %7zu %8lu %8lu %10lu %10lu",
+                       replacement_policy_name(policies[p]), assocs[a], pools[n],
+                       res.runs, res.success,
+                       (unsigned long)percentile(res.calls, res.runs, 0.50),
+                       (unsigned long)percentile(res.calls, res.runs, 0.95),
+                       (unsigned long)percentile(res.loads, res.runs, 0.50),
+                       (unsigned long)percentile(res.loads, res.runs, 0.95));
+                if (res.no_evict)
+                    printf("  (%zu pools did not evict)", res.no_evict);
+                printf("\n");
+            }
+        }
+    }
+
+    free(res.calls);
+    free(res.loads);
+    return 0;
+}
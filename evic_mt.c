@@ -0,0 +1,330 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "threshold_group_testing.h"
+#include "address_set_adapter.h"
+#include "cache_model.h"
+#include "oracle_stats.h"
+#include "binary_search_reduction.h"
+#include "static_group_reduction.h"
+#include "evmap.h"
+#include "traversal.h"
+#include "prng.h"
+
+/*
+* Multi-threaded eviction set mapping: one target per cache set, spread over
+* worker threads through work-stealing queues. Every worker owns its oracle
+* (cache model instance or m5-op), PRNG, candidate pool and reducer run; the
+* per-set results are merged into one table at the end.
+*/
+
+#define MAX_GROWTHS 7   // a worker's pool never grows past pool_size << MAX_GROWTHS
+
+typedef struct {
+    pthread_mutex_t lock;
+    size_t *items;
+    size_t head;   // owner pops here
+    size_t tail;   // thieves steal here
+} work_queue_t;
+
+typedef struct {
+    const char *oracle_name;
+    replacement_policy_t policy;
+    reduction_func_t reducer;
+    traversal_mode_t traversal;
+    const traversal_pattern_t *pattern;
+    int use_prefix;
+    cache_config_t cfg;
+    size_t pool_size;
+    int tries;
+    uint8_t *targets;          // num_sets lines, targets[s * line] maps to set s
+    address_set_t *results;    // one slot per set, written only by the worker that took it
+    work_queue_t *queues;
+    size_t num_workers;
+} mt_shared_t;
+
+typedef struct {
+    mt_shared_t *shared;
+    size_t id;
+    uint64_t seed;
+    oracle_stats_t stats;
+    size_t done;
+    size_t stolen;
+    address_set_t pool;        // grown in place and kept alive: the results point into it
+} mt_worker_t;
+
+static int queue_pop(work_queue_t *q, size_t *item)
+{
+    int ok = 0;
+    pthread_mutex_lock(&q->lock);
+    if (q->head < q->tail) {
+        *item = q->items[q->head++];
+        ok = 1;
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ok;
+}
+
+static int queue_steal(work_queue_t *q, size_t *item)
+{
+    int ok = 0;
+    pthread_mutex_lock(&q->lock);
+    if (q->head < q->tail) {
+        *item = q->items[--q->tail];
+        ok = 1;
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ok;
+}
+
+static int next_target(mt_worker_t *w, size_t *item)
+{
+    mt_shared_t *sh = w->shared;
+    if (queue_pop(&sh->queues[w->id], item)) return 1;
+
+    for (size_t k = 1; k < sh->num_workers; k++) {
+        if (queue_steal(&sh->queues[(w->id + k) % sh->num_workers], item)) {
+            w->stolen++;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void *worker_main(void *arg)
+{
+    mt_worker_t *w = (mt_worker_t *)arg;
+    mt_shared_t *sh = w->shared;
+    const cache_config_t *cfg = &sh->cfg;
+
+    prng_t rng;
+    prng_seed(&rng, w->seed);
+
+    test_context_t ctx = {0};
+    cache_model_t *model = NULL;
+    eviction_test_func_t oracle;
+    if (strcmp(sh->oracle_name, "model") == 0) {
+        model = cache_model_create(cfg, sh->policy, w->seed);
+        if (!model) return NULL;
+        ctx.oracle_state = model;
+        oracle = create_cache_model_tester();
+    } else {
+        oracle = create_eviction_tester();
+    }
+    oracle = oracle_stats_wrap(&w->stats, oracle);
+    ctx.stats = &w->stats;
+    ctx.traversal = sh->traversal;
+    ctx.pattern = sh->pattern;
+
+    size_t s;
+    while (next_target(w, &s)) {
+        void *target = sh->targets + s * cfg->cache_line_size;
+        ctx.target_address = target;
+
+        // Reuse the pool: only the offset inside the stride moves
+        address_set_t *pool = &w->pool;
+        if (pool->addresses) retarget_candidate_set(pool, target, cfg);
+
+        int evicts = pool->addresses && oracle(pool, &ctx);
+        for (int t = 0; !evicts && t < sh->tries; t++) {
+            if (!pool->addresses)
+                *pool = generate_candidate_set_r(target, sh->pool_size, cfg, &rng);
+            else if (pool->size < (sh->pool_size << MAX_GROWTHS))
+                grow_candidate_set(pool, target, pool->size, cfg, &rng);
+            else
+                break;
+            evicts = oracle(pool, &ctx);
+        }
+        if (!evicts) continue;
+
+        address_set_t found = sh->use_prefix ? prefix_reduction(sh->reducer, pool, cfg, oracle, &ctx)
+                                             : sh->reducer(pool, cfg, oracle, &ctx);
+        if (found.size == cfg->associativity && oracle(&found, &ctx)) {
+            sh->results[s] = found;
+            w->done++;
+        } else {
+            free_address_set(&found);
+        }
+    }
+
+    cache_model_destroy(model);
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned seed = 12345;
+    size_t num_workers = 4;
+    size_t pool_size = 128;
+    int tries = 3;
+    const char *oracle_name = "model";
+    replacement_policy_t policy = REPL_LRU;
+    reduction_func_t reducer = threshold_group_reduction;
+    traversal_mode_t traversal = TRAVERSE_ARRAY;
+    traversal_pattern_t pattern = { 1, 0, TRAVERSE_FORWARD };
+    int use_pattern = 0;
+    int use_prefix = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            num_workers = (size_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (unsigned)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--pool") == 0 && i + 1 < argc) {
+            pool_size = (size_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--tries") == 0 && i + 1 < argc) {
+            tries = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--oracle") == 0 && i + 1 < argc) {
+            oracle_name = argv[++i];
+            if (strcmp(oracle_name, "m5") != 0 && strcmp(oracle_name, "model") != 0) {
+                fprintf(stderr, "Unknown oracle: %s\n", oracle_name);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--policy") == 0 && i + 1 < argc) {
+            if (!parse_replacement_policy(argv[++i], &policy)) {
+                fprintf(stderr, "Unknown replacement policy: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--reducer") == 0 && i + 1 < argc) {
+            const char *name = argv[++i];
+            if (strcmp(name, "tgt") == 0) {
+                reducer = threshold_group_reduction;
+            } else if (strcmp(name, "tgt-static") == 0) {
+                reducer = static_group_reduction;
+            } else if (strcmp(name, "bs") == 0) {
+                reducer = binary_search_reduction;
+            } else {
+                fprintf(stderr, "Unknown reducer: %s\n", name);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--chase") == 0) {
+            traversal = TRAVERSE_CHASE;
+        } else if (strcmp(argv[i], "--pattern") == 0 && i + 1 < argc) {
+            if (!parse_traversal_pattern(argv[++i], &pattern)) {
+                fprintf(stderr, "Bad traversal pattern: %s\n", argv[i]);
+                return 1;
+            }
+            use_pattern = 1;
+        } else if (strcmp(argv[i], "--no-prefix") == 0) {
+            use_prefix = 0;
+        } else if (strcmp(argv[i], "--help") == 0) {
+            printf("Usage: %s [--threads <N>] [--seed <S>] [--pool <N>] [--tries <N>]"
+                   " [--oracle m5|model] [--policy lru|plru|random|rrip]"
+                   " [--reducer tgt|tgt-static|bs] [--chase] [--pattern <r:w:dir>]"
+                   " [--no-prefix]\n", argv[0]);
+            return 0;
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (num_workers == 0) num_workers = 1;
+
+    reduction_verbose = 0;
+
+    mt_shared_t sh;
+    memset(&sh, 0, sizeof(sh));
+    sh.oracle_name = oracle_name;
+    sh.policy = policy;
+    sh.reducer = reducer;
+    sh.traversal = traversal;
+    sh.pattern = use_pattern ? &pattern : NULL;
+    sh.use_prefix = use_prefix;
+    sh.cfg = (cache_config_t){
+        .associativity   = 8,
+        .cache_line_size = 64,
+        .page_size       = 4096,
+        .l2_size         = 256 * 1024
+    };
+    sh.pool_size = pool_size;
+    sh.tries = tries;
+    sh.num_workers = num_workers;
+
+    size_t num_sets = sh.cfg.l2_size / (sh.cfg.cache_line_size * sh.cfg.associativity);
+    size_t stride = num_sets * sh.cfg.cache_line_size;
+
+    sh.targets = aligned_alloc(stride, stride);
+    sh.results = calloc(num_sets, sizeof(address_set_t));
+    sh.queues = calloc(num_workers, sizeof(work_queue_t));
+    size_t *items = malloc(num_sets * sizeof(size_t));
+    mt_worker_t *workers = calloc(num_workers, sizeof(mt_worker_t));
+    pthread_t *threads = malloc(num_workers * sizeof(pthread_t));
+    if (!sh.targets || !sh.results || !sh.queues || !items || !workers || !threads) {
+        perror("alloc");
+        return 1;
+    }
+    memset(sh.targets, 0xAB, stride);
+
+    // Contiguous share of the set indices per worker, the rest is stolen on demand
+    for (size_t s = 0; s < num_sets; s++) items[s] = s;
+    for (size_t q = 0; q < num_workers; q++) {
+        pthread_mutex_init(&sh.queues[q].lock, NULL);
+        sh.queues[q].items = items;
+        sh.queues[q].head = q * num_sets / num_workers;
+        sh.queues[q].tail = (q + 1) * num_sets / num_workers;
+    }
+
+    printf("Mapping %zu sets with %zu threads (%s oracle)\n", num_sets, num_workers, oracle_name);
+
+    for (size_t t = 0; t < num_workers; t++) {
+        workers[t].shared = &sh;
+        workers[t].id = t;
+        workers[t].seed = (uint64_t)seed * 1000003u + t;
+        if (pthread_create(&threads[t], NULL, worker_main, &workers[t]) != 0) {
+            perror("pthread_create");
+            return 1;
+        }
+    }
+
+    oracle_stats_t total = {0};
+    oracle_stats_reset(&total);
+    for (size_t t = 0; t < num_workers; t++) {
+        pthread_join(threads[t], NULL);
+
+        const oracle_stats_t *st = &workers[t].stats;
+        printf("  worker %zu: %zu sets (%zu stolen), %lu calls, %lu loads\n",
+               t, workers[t].done, workers[t].stolen,
+               (unsigned long)st->calls, (unsigned long)st->loads);
+
+        total.calls += st->calls;
+        total.positives += st->positives;
+        total.loads += st->loads;
+        total.retries += st->retries;
+        if (st->min_set_size < total.min_set_size) total.min_set_size = st->min_set_size;
+        if (st->max_set_size > total.max_set_size) total.max_set_size = st->max_set_size;
+        for (size_t k = 0; k < ORACLE_STATS_SIZE_BUCKETS; k++)
+            total.size_hist[k] += st->size_hist[k];
+    }
+
+    // Merge: the per-set results already form the table
+    eviction_map_t map = {0};
+    map.num_slots = num_sets;
+    map.lines_per_page = sh.cfg.page_size / sh.cfg.cache_line_size;
+    map.colors = num_sets / map.lines_per_page;
+    map.sets = sh.results;
+
+    size_t mapped = 0;
+    for (size_t s = 0; s < num_sets; s++)
+        mapped += (sh.results[s].size == sh.cfg.associativity);
+    printf("Mapped %zu/%zu sets\n", mapped, num_sets);
+    oracle_stats_print(&total, "All workers");
+
+    if (dump_eviction_map(&map, &sh.cfg, "evmap_mt_dump.txt") == 0)
+        printf("Dumped eviction set map to evmap_mt_dump.txt\n");
+
+    free_eviction_map(&map);
+    for (size_t t = 0; t < num_workers; t++)
+        free_address_set(&workers[t].pool);
+    for (size_t q = 0; q < num_workers; q++)
+        pthread_mutex_destroy(&sh.queues[q].lock);
+
+    free(threads);
+    free(workers);
+    free(items);
+    free(sh.queues);
+    free(sh.targets);
+    return mapped == num_sets ? 0 : -1;
+}
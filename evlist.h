@@ -0,0 +1,58 @@
+#ifndef EVLIST_H
+#define EVLIST_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+* Intrusive linked list through the candidate lines: the first word of every
+* line holds the address of the next line, 0 ends the chain. A traversal is a
+* chain of dependent loads that touches only the lines under test, and removing
+* a contiguous run of lines is a single store into the line before it.
+*/
+
+static inline uintptr_t evlist_next(uintptr_t line) {
+    return *(volatile uintptr_t *)line;
+}
+
+static inline void evlist_set_next(uintptr_t line, uintptr_t next) {
+    *(volatile uintptr_t *)line = next;
+}
+
+/*
+* Link addresses[0..n) in array order
+* Returns the head of the chain (0 for an empty array)
+*/
+static inline uintptr_t evlist_link(const uintptr_t *addresses, size_t n) {
+    if (n == 0) return 0;
+    for (size_t i = 0; i + 1 < n; i++) {
+        evlist_set_next(addresses[i], addresses[i + 1]);
+    }
+    evlist_set_next(addresses[n - 1], 0);
+    return addresses[0];
+}
+
+/*
+* Unlink the run addresses[start..start+len) from a chain built by evlist_link()
+* over addresses[0..n). Returns the new head; evlist_restore() undoes it.
+*/
+static inline uintptr_t evlist_splice_out(const uintptr_t *addresses, size_t n,
+                                          size_t start, size_t len) {
+    uintptr_t after = (start + len < n) ? addresses[start + len] : 0;
+    if (start == 0) return after;
+    evlist_set_next(addresses[start - 1], after);
+    return addresses[0];
+}
+
+static inline void evlist_restore(const uintptr_t *addresses, size_t start) {
+    if (start > 0) evlist_set_next(addresses[start - 1], addresses[start]);
+}
+
+// Dependent load through every line of the chain
+static inline void evlist_traverse(uintptr_t head) {
+    uintptr_t p = head;
+    while (p) p = evlist_next(p);
+    asm volatile("" ::: "memory");
+}
+
+#endif //EVLIST_H
@@ -0,0 +1,215 @@
+#include "evmap.h"
+#include "address_set_adapter.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int contains(const address_set_t *set, uintptr_t addr)
+{
+    for (size_t i = 0; i < set->size; i++) {
+        if (set->addresses[i] == addr) return 1;
+    }
+    return 0;
+}
+
+// Drop the addresses of @found from pool[0..*n), order is not preserved
+static void remove_from_pool(uintptr_t *pool, size_t *n, const address_set_t *found)
+{
+    size_t i = 0;
+    while (i < *n) {
+        if (contains(found, pool[i]))
+            pool[i] = pool[--(*n)];
+        else
+            i++;
+    }
+}
+
+static address_set_t shifted_set(const address_set_t *set, uintptr_t shift)
+{
+    address_set_t out = create_address_set(set->size);
+    for (size_t i = 0; i < set->size; i++)
+        out.addresses[i] = set->addresses[i] + shift;
+    out.size = set->size;
+    return out;
+}
+
+/*
+* Drop from pool[0..*n) and mark in held[0..num_held) every address that @set evicts.
+* Batches of `associativity` targets cannot evict each other while being primed.
+*/
+static void classify_against(const address_set_t *set, size_t batch,
+                             uintptr_t *pool, size_t *n,
+                             uintptr_t *held, int *held_known, size_t num_held,
+                             batch_eviction_test_func_t batch_func,
+                             const test_context_t *context)
+{
+    void *targets[MAX_BATCH_TARGETS];
+
+    for (size_t i = 0; i < num_held; i += batch) {
+        size_t k = (num_held - i < batch) ? num_held - i : batch;
+        for (size_t t = 0; t < k; t++) targets[t] = (void *)held[i + t];
+        uint64_t evicted = batch_func(set, targets, k, context);
+        for (size_t t = 0; t < k; t++) {
+            if (evicted & (1ull << t)) held_known[i + t] = 1;
+        }
+    }
+
+    // Compact the survivors forward, the write index never passes the read index
+    size_t out = 0;
+    for (size_t i = 0; i < *n; i += batch) {
+        size_t k = (*n - i < batch) ? *n - i : batch;
+        for (size_t t = 0; t < k; t++) targets[t] = (void *)pool[i + t];
+        uint64_t evicted = batch_func(set, targets, k, context);
+
+        for (size_t t = 0; t < k; t++) {
+            if (!(evicted & (1ull << t))) pool[out++] = (uintptr_t)targets[t];
+        }
+    }
+    *n = out;
+}
+
+eviction_map_t build_eviction_map(const cache_config_t *config,
+                                  size_t pool_size,
+                                  reduction_func_t reducer,
+                                  eviction_test_func_t test_func,
+                                  batch_eviction_test_func_t batch_func,
+                                  test_context_t *context)
+{
+    size_t a = config->associativity;
+    size_t line = config->cache_line_size;
+    size_t batch = a < MAX_BATCH_TARGETS ? a : MAX_BATCH_TARGETS;
+
+    eviction_map_t map;
+    map.num_slots = config->l2_size / (line * a);
+    map.lines_per_page = config->page_size / line;
+    map.colors = 0;
+
+    size_t max_colors = map.num_slots / map.lines_per_page;
+    if (max_colors == 0) max_colors = 1;
+
+    map.sets = calloc(map.num_slots, sizeof(address_set_t));
+    if (!map.sets) {
+        perror("calloc eviction map");
+        exit(1);
+    }
+
+    map.pool = generate_page_candidate_set(pool_size, config);
+
+    // Unassigned candidates, shrinks as targets and found sets are taken out
+    uintptr_t *P = malloc(pool_size * sizeof(uintptr_t));
+    if (!P) {
+        perror("malloc pool index");
+        exit(1);
+    }
+    memcpy(P, map.pool.addresses, pool_size * sizeof(uintptr_t));
+    size_t n = pool_size;
+
+    address_set_t *color_sets = calloc(max_colors, sizeof(address_set_t));
+    if (!color_sets) {
+        perror("calloc color sets");
+        exit(1);
+    }
+
+    uintptr_t held[MAX_BATCH_TARGETS];
+    int held_known[MAX_BATCH_TARGETS];
+    void *targets[MAX_BATCH_TARGETS];
+
+    while (map.colors < max_colors && n > a + 1) {
+        // Take a batch of targets out of the pool, one traversal tells which
+        // ones the rest of the pool still evicts
+        size_t k = (n - (a + 1) < batch) ? n - (a + 1) : batch;
+        for (size_t t = 0; t < k; t++) {
+            held[t] = P[--n];
+            held_known[t] = 0;
+            targets[t] = (void *)held[t];
+        }
+
+        address_set_t rest = address_set_view(P, n);
+        uint64_t evicted = batch_func(&rest, targets, k, context);
+
+        for (size_t t = 0; t < k && map.colors < max_colors; t++) {
+            if (held_known[t]) continue;
+            if (!(evicted & (1ull << t))) {
+                TGT_LOG("[EvMap] pool of %zu does not evict 0x%lx, dropping it\n", n, held[t]);
+                continue;
+            }
+
+            context->target_address = (void *)held[t];
+            rest = address_set_view(P, n);
+            address_set_t found = reducer(&rest, config, test_func, context);
+            if (found.size != a || !test_func(&found, context)) {
+                TGT_LOG("[EvMap] reduction for 0x%lx failed (size %zu)\n", held[t], found.size);
+                free_address_set(&found);
+                continue;
+            }
+
+            remove_from_pool(P, &n, &found);
+            color_sets[map.colors++] = found;
+
+            // Whatever the new set evicts has this color: drop it from the
+            // pool and from the rest of the batch
+            classify_against(&found, batch, P, &n, &held[t + 1], &held_known[t + 1],
+                             k - t - 1, batch_func, context);
+            TGT_LOG("[EvMap] color %zu/%zu found, %zu candidates left\n",
+                    map.colors, max_colors, n);
+        }
+    }
+
+    // Every line offset of a color set's pages gives the set next to it
+    for (size_t c = 0; c < map.colors; c++) {
+        for (size_t l = 0; l < map.lines_per_page; l++) {
+            size_t slot = c * map.lines_per_page + l;
+            if (slot >= map.num_slots) break;
+            map.sets[slot] = shifted_set(&color_sets[c], l * line);
+        }
+        free_address_set(&color_sets[c]);
+    }
+
+    free(color_sets);
+    free(P);
+    return map;
+}
+
+void free_eviction_map(eviction_map_t *map)
+{
+    for (size_t i = 0; i < map->num_slots; i++) {
+        if (map->sets[i].addresses) free_address_set(&map->sets[i]);
+    }
+    free(map->sets);
+    map->sets = NULL;
+    free_address_set(&map->pool);
+}
+
+int dump_eviction_map(const eviction_map_t *map, const cache_config_t *config,
+                      const char *path)
+{
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        perror("fopen eviction map");
+        return -1;
+    }
+
+    size_t num_sets = config->l2_size / (config->cache_line_size * config->associativity);
+
+    fprintf(f, "# l2_size=%zu\n", config->l2_size);
+    fprintf(f, "# associativity=%zu\n", config->associativity);
+    fprintf(f, "# cache_line=%zu\n", config->cache_line_size);
+    fprintf(f, "# page_size=%zu\n", config->page_size);
+    fprintf(f, "# colors=%zu lines_per_page=%zu\n", map->colors, map->lines_per_page);
+    fprintf(f, "# slot  virtual_set_index  addresses\n");
+
+    for (size_t slot = 0; slot < map->num_slots; slot++) {
+        const address_set_t *set = &map->sets[slot];
+        if (set->size == 0) continue;
+
+        size_t vindex = (set->addresses[0] / config->cache_line_size) % num_sets;
+        fprintf(f, "%zu %zu", slot, vindex);
+        for (size_t i = 0; i < set->size; i++)
+            fprintf(f, " 0x%lx", (unsigned long)set->addresses[i]);
+        fprintf(f, "\n");
+    }
+
+    fclose(f);
+    return 0;
+}
@@ -0,0 +1,43 @@
+#ifndef EVMAP_H
+#define EVMAP_H
+
+#include "threshold_group_testing.h"
+
+/*
+* Eviction sets for every set of the cache, found from one page-stride pool.
+*
+* Only the page offset of an address is known to match its physical address,
+* so the sets found at page offset 0 are numbered by page color in discovery
+* order. Slot (color * lines_per_page + line) holds the color set shifted by
+* `line` cache lines inside the same pages.
+*/
+typedef struct {
+    size_t num_slots;          // number of cache sets
+    size_t lines_per_page;
+    size_t colors;             // colors found (num_slots / lines_per_page when complete)
+    address_set_t *sets;       // sets[slot], size 0 when the color was not found
+    address_set_t pool;        // owns the memory every set points into
+} eviction_map_t;
+
+
+/*
+* Build the map from a pool of @pool_size pages
+* @batch_func: Screens several pool targets per traversal, and after each new
+*              color drops every candidate of that color in one call per batch
+* @context: target_address is overwritten for every pool target, the rest is used as is
+* Returns a map with `colors` colors found, the caller frees it with free_eviction_map()
+*/
+eviction_map_t build_eviction_map(const cache_config_t *config,
+                                  size_t pool_size,
+                                  reduction_func_t reducer,
+                                  eviction_test_func_t test_func,
+                                  batch_eviction_test_func_t batch_func,
+                                  test_context_t *context);
+
+void free_eviction_map(eviction_map_t *map);
+
+// Write slot, virtual set index of the first line and the set's addresses
+int dump_eviction_map(const eviction_map_t *map, const cache_config_t *config,
+                      const char *path);
+
+#endif //EVMAP_H
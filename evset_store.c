@@ -0,0 +1,294 @@
+#include "evset_store.h"
+#include "address_set_adapter.h"
+#include "binary_search_reduction.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+// A line is written before its first use, a page only read maps the shared zero page
+static inline void touch_line(uintptr_t addr)
+{
+    *(volatile uint8_t *)addr = 0xA5;
+}
+
+void evset_region_map(evset_region_t *region, const cache_config_t *cfg,
+                      size_t num_sets, size_t pool_lines, int hugepages)
+{
+    size_t level_sets = cfg->l2_size / (cfg->associativity * cfg->cache_line_size);
+    memset(region, 0, sizeof(*region));
+    region->stride = level_sets * cfg->cache_line_size;
+    region->pool_lines = pool_lines;
+    region->num_sets = num_sets < level_sets ? num_sets : level_sets;
+    region->hugepages = hugepages;
+    region->bytes = region->stride * pool_lines;
+
+    if (hugepages) {
+        region->bytes = (region->bytes + HUGE_PAGE_SIZE - 1) & ~(size_t)(HUGE_PAGE_SIZE - 1);
+        region->base = map_hugepage_region(region->bytes, &region->huge);
+        return;
+    }
+
+    // Stride-aligned, so that an offset maps to the same set index in every process
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t slack = region->stride > page ? region->stride : 0;
+    size_t span = region->bytes + slack;
+    uint8_t *raw = mmap(NULL, span, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (raw == MAP_FAILED) {
+        perror("mmap eviction set region");
+        exit(1);
+    }
+    uintptr_t base = slack ? (((uintptr_t)raw + slack - 1) & ~(uintptr_t)(slack - 1))
+                           : (uintptr_t)raw;
+    size_t head = base - (uintptr_t)raw;
+    size_t tail = span - head - region->bytes;
+    if (head) munmap(raw, head);
+    if (tail) munmap((uint8_t *)base + region->bytes, tail);
+    region->base = (uint8_t *)base;
+}
+
+void evset_region_unmap(evset_region_t *region)
+{
+    if (region->base) munmap(region->base, region->bytes);
+    region->base = NULL;
+}
+
+static void fill_header(evset_store_header_t *h, const evset_region_t *region,
+                        const cache_config_t *cfg, int level)
+{
+    memset(h, 0, sizeof(*h));
+    h->magic = EVSET_STORE_MAGIC;
+    h->version = EVSET_STORE_VERSION;
+    h->associativity = cfg->associativity;
+    h->cache_line_size = cfg->cache_line_size;
+    h->page_size = cfg->page_size;
+    h->l2_size = cfg->l2_size;
+    h->target_level = (uint32_t)level;
+    h->hugepages = (uint32_t)region->hugepages;
+    h->huge = (uint32_t)region->huge;
+    h->region_bytes = region->bytes;
+    h->stride = region->stride;
+    h->pool_lines = region->pool_lines;
+    h->num_sets = region->num_sets;
+    h->entry_size = sizeof(evset_store_entry_t) + cfg->associativity * sizeof(uint64_t);
+}
+
+/*
+* Map the store read-only when its key matches @expect
+* Returns the header, entries follow it; NULL when missing or stale
+*/
+static const evset_store_header_t *map_store(const char *path,
+                                             const evset_store_header_t *expect,
+                                             size_t *bytes)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    void *p = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(evset_store_header_t))
+        p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return NULL;
+
+    const evset_store_header_t *h = p;
+    *bytes = st.st_size;
+    if (memcmp(h, expect, sizeof(*h)) != 0 ||
+        *bytes != sizeof(*h) + h->num_sets * h->entry_size) {
+        TGT_LOG("[EvStore] %s was written for another configuration or layout, ignoring it\n",
+                path);
+        munmap(p, *bytes);
+        return NULL;
+    }
+    return h;
+}
+
+static const evset_store_entry_t *store_entry(const evset_store_header_t *h, size_t i)
+{
+    return (const evset_store_entry_t *)((const uint8_t *)(h + 1) + i * h->entry_size);
+}
+
+/*
+* Candidates of set @s: its line in every other stride of the region, shuffled,
+* with the lines of @keep (a failed stored set) moved to the front
+*/
+static address_set_t column_pool(const evset_region_t *region, size_t s, size_t line,
+                                 const address_set_t *keep, prng_t *rng)
+{
+    uintptr_t target = (uintptr_t)region->base + s * line;
+    size_t n = region->pool_lines - 1;
+    address_set_t pool = create_address_set(n);
+
+    for (size_t k = 0; k < n; k++) {
+        uintptr_t addr = target + (k + 1) * region->stride;
+        touch_line(addr);
+        pool.addresses[k] = addr;
+    }
+    for (size_t i = n - 1; i > 0; i--) {
+        size_t j = prng_below(rng, i + 1);
+        uintptr_t tmp = pool.addresses[i];
+        pool.addresses[i] = pool.addresses[j];
+        pool.addresses[j] = tmp;
+    }
+
+    size_t front = 0;
+    for (size_t i = 0; keep && i < keep->size; i++) {
+        for (size_t k = front; k < n; k++) {
+            if (pool.addresses[k] != keep->addresses[i]) continue;
+            pool.addresses[k] = pool.addresses[front];
+            pool.addresses[front++] = keep->addresses[i];
+            break;
+        }
+    }
+    pool.size = n;
+    return pool;
+}
+
+size_t evset_store_sync(const char *path, const evset_region_t *region,
+                        const cache_config_t *cfg, int level,
+                        reduction_func_t reducer, int use_prefix,
+                        eviction_test_func_t test_func, test_context_t *context,
+                        prng_t *rng, address_set_t *sets, evset_store_stats_t *stats)
+{
+    size_t a = cfg->associativity;
+    size_t line = cfg->cache_line_size;
+    uintptr_t base = (uintptr_t)region->base;
+    double start = now_ms();
+
+    memset(stats, 0, sizeof(*stats));
+    memset(sets, 0, region->num_sets * sizeof(address_set_t));
+
+    evset_store_header_t expect;
+    fill_header(&expect, region, cfg, level);
+    size_t store_bytes = 0;
+    const evset_store_header_t *store = path ? map_store(path, &expect, &store_bytes) : NULL;
+
+    // Validation: one oracle call per stored set
+    int *stale = calloc(region->num_sets, sizeof(int));
+    if (!stale) {
+        perror("calloc eviction set store");
+        exit(1);
+    }
+    for (size_t s = 0; store && s < region->num_sets; s++) {
+        const evset_store_entry_t *e = store_entry(store, s);
+        if (e->size != a || e->target != s * line) continue;
+
+        address_set_t set = create_address_set(a);
+        int in_region = 1;
+        for (size_t i = 0; i < a && in_region; i++) {
+            in_region = e->lines[i] < region->bytes;
+            set.addresses[i] = base + e->lines[i];
+        }
+        if (!in_region) {
+            free_address_set(&set);
+            continue;
+        }
+        set.size = a;
+        for (size_t i = 0; i < a; i++) touch_line(set.addresses[i]);
+        touch_line(base + e->target);
+
+        stats->loaded++;
+        context->target_address = (void *)(base + e->target);
+        sets[s] = set;
+        if (test_func(&sets[s], context)) stats->valid++;
+        else stale[s] = 1;
+    }
+    if (store) munmap((void *)store, store_bytes);
+
+    // Everything the store could not vouch for is reduced from its column
+    for (size_t s = 0; s < region->num_sets; s++) {
+        if (sets[s].size == a && !stale[s]) continue;
+
+        void *target = region->base + s * line;
+        touch_line((uintptr_t)target);
+        context->target_address = target;
+
+        address_set_t pool = column_pool(region, s, line, stale[s] ? &sets[s] : NULL, rng);
+        free_address_set(&sets[s]);
+        sets[s] = (address_set_t){0};
+
+        if (test_func(&pool, context)) {
+            address_set_t found = use_prefix ? prefix_reduction(reducer, &pool, cfg, test_func, context)
+                                             : reducer(&pool, cfg, test_func, context);
+            if (found.size == a && test_func(&found, context)) {
+                sets[s] = found;
+                stats->reduced++;
+            } else {
+                free_address_set(&found);
+            }
+        } else {
+            TGT_LOG("[EvStore] column of set %zu does not evict its target\n", s);
+        }
+        free_address_set(&pool);
+        if (sets[s].size != a) stats->missing++;
+    }
+    free(stale);
+
+    size_t found = region->num_sets - stats->missing;
+    stats->elapsed_ms = now_ms() - start;
+
+    // Only new or stale sets change the file: sets that failed twice stay missing
+    if (path && (stats->reduced || stats->valid != stats->loaded) &&
+        evset_store_save(path, region, cfg, level, sets) == 0)
+        TGT_LOG("[EvStore] saved %zu sets to %s\n", found, path);
+    return found;
+}
+
+int evset_store_save(const char *path, const evset_region_t *region,
+                     const cache_config_t *cfg, int level, const address_set_t *sets)
+{
+    evset_store_header_t h;
+    fill_header(&h, region, cfg, level);
+
+    evset_store_entry_t *e = calloc(1, h.entry_size);
+    char *tmp = malloc(strlen(path) + 5);
+    if (!e || !tmp) {
+        perror("malloc eviction set store");
+        exit(1);
+    }
+    sprintf(tmp, "%s.tmp", path);
+
+    FILE *f = fopen(tmp, "wb");
+    if (!f) {
+        perror("fopen eviction set store");
+        free(tmp);
+        free(e);
+        return -1;
+    }
+
+    int ok = fwrite(&h, sizeof(h), 1, f) == 1;
+    uintptr_t base = (uintptr_t)region->base;
+    for (size_t s = 0; ok && s < region->num_sets; s++) {
+        memset(e, 0, h.entry_size);
+        e->target = s * cfg->cache_line_size;
+        if (sets[s].size == cfg->associativity) {
+            e->size = sets[s].size;
+            for (size_t i = 0; i < sets[s].size; i++)
+                e->lines[i] = sets[s].addresses[i] - base;
+        }
+        ok = fwrite(e, h.entry_size, 1, f) == 1;
+    }
+    if (fclose(f) != 0) ok = 0;
+    if (ok && rename(tmp, path) != 0) ok = 0;
+    if (!ok) {
+        perror("write eviction set store");
+        unlink(tmp);
+    }
+
+    free(tmp);
+    free(e);
+    return ok ? 0 : -1;
+}
@@ -0,0 +1,104 @@
+#ifndef EVSET_STORE_H
+#define EVSET_STORE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "threshold_group_testing.h"
+#include "prng.h"
+
+#define EVSET_STORE_MAGIC   0x54535645u   // "EVST"
+#define EVSET_STORE_VERSION 2
+
+/*
+* Persistent eviction sets: the lines of each set are kept as offsets into a
+* region that every process maps the same way, so a later run only re-creates
+* the region and checks each set with one oracle call instead of searching.
+*
+* Region layout: stride-aligned, pool_lines strides long. The target of cache
+* set s is the line at s * cache_line_size, its candidates are the same line
+* of every other stride.
+* Only a region in huge pages is physically reproducible: with 4K pages a
+* stride larger than a page puts the lines of one offset in other cache sets
+* on every run, so stored sets mostly fail validation and are reduced again.
+* Whether the region got huge pages is part of the store key.
+*/
+typedef struct {
+    uint8_t *base;
+    size_t bytes;
+    size_t stride;
+    size_t pool_lines;      // strides in the region, one candidate each per set
+    size_t num_sets;        // targets, from set 0 up
+    int hugepages;
+    int huge;               // the whole region is known to be in huge pages
+} evset_region_t;
+
+// File header, followed by num_sets entries of entry_size bytes
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    // Cache configuration the sets were found for
+    uint64_t associativity;
+    uint64_t cache_line_size;
+    uint64_t page_size;
+    uint64_t l2_size;
+    uint32_t target_level;
+    uint32_t hugepages;
+    // Allocation layout the offsets are relative to
+    uint32_t huge;
+    uint32_t reserved;
+    uint64_t region_bytes;
+    uint64_t stride;
+    uint64_t pool_lines;
+    uint64_t num_sets;
+    uint64_t entry_size;
+} evset_store_header_t;
+
+// Entry: target offset, line count (0 when the set was not found), then the line offsets
+typedef struct {
+    uint64_t target;
+    uint64_t size;
+    uint64_t lines[];
+} evset_store_entry_t;
+
+typedef struct {
+    size_t loaded;          // sets read from the store
+    size_t valid;           // of those, still evicting their target
+    size_t reduced;         // sets (re)built by a reduction
+    size_t missing;         // sets without an eviction set in the end
+    double elapsed_ms;
+} evset_store_stats_t;
+
+/*
+* Map the region for the first @num_sets cache sets of @cfg, @pool_lines strides long
+* Nothing is faulted in: the lines in use are written as the sets need them
+*/
+void evset_region_map(evset_region_t *region, const cache_config_t *cfg,
+                      size_t num_sets, size_t pool_lines, int hugepages);
+void evset_region_unmap(evset_region_t *region);
+
+/*
+* Warm start: load the store at @path if its key matches @cfg, @level and the
+* region, and keep every set that still evicts its target; reduce the others
+* and the sets the store does not have from their column of the region. The
+* store is rewritten when anything changed.
+* A failed set is re-reduced incrementally: its old lines go first in the pool,
+* where the shortest evicting prefix (@use_prefix) finds the ones still congruent.
+* @sets: region->num_sets slots, set s is left empty when no eviction set was found
+* Returns the number of sets found
+*/
+size_t evset_store_sync(const char *path, const evset_region_t *region,
+                        const cache_config_t *cfg, int level,
+                        reduction_func_t reducer, int use_prefix,
+                        eviction_test_func_t test_func, test_context_t *context,
+                        prng_t *rng, address_set_t *sets, evset_store_stats_t *stats);
+
+/*
+* Write @sets (region->num_sets slots) to @path through a temporary file and a
+* rename, so that a reader never maps a half-written store
+* Returns 0 on success, -1 on error
+*/
+int evset_store_save(const char *path, const evset_region_t *region,
+                     const cache_config_t *cfg, int level, const address_set_t *sets);
+
+#endif //EVSET_STORE_H
@@ -2,9 +2,27 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <gem5/m5ops.h>
 
 #include "threshold_group_testing.h"
 #include "address_set_adapter.h"
+#include "cache_model.h"
+#include "oracle_stats.h"
+#include "binary_search_reduction.h"
+#include "static_group_reduction.h"
+#include "evmap.h"
+#include "voting_oracle.h"
+#include "timing.h"
+#include "pagemap.h"
+#include "cache_hierarchy.h"
+#include "slice_hash.h"
+#include "traversal.h"
+#include "oracle_trace.h"
+#include "sweep.h"
+#include "prng.h"
+#include "phase_profile.h"
+#include "evset_store.h"
 
 static address_set_t create_tmp_set_from_array(uintptr_t *addrs, size_t n)
 {
@@ -15,18 +33,327 @@ static address_set_t create_tmp_set_from_array(uintptr_t *addrs, size_t n)
     return tmp;
 }
 
+static void release_target(uint8_t *target, int hugepages)
+{
+    if (hugepages)
+        munmap(target, HUGE_PAGE_SIZE);
+    else
+        free(target);
+}
+
+// Offset of @addr in the pool, counted across the chunks of a grown pool
+static uintptr_t pool_offset(const address_set_t *pool, uintptr_t addr)
+{
+    uintptr_t skipped = 0;
+    for (const pool_chunk_t *c = pool->chunks; c; c = c->next) {
+        uintptr_t base = (uintptr_t)c->base;
+        if (addr >= base && addr < base + c->bytes) return skipped + (addr - base);
+        skipped += c->bytes;
+    }
+    return addr - (uintptr_t)pool->backing;
+}
+
+// Show the tail of the oracle trace at verbosity 3, dump it to @path and release it
+static void finish_trace(oracle_trace_t *trace, const char *path)
+{
+    if (!trace->records) return;
+    if (reduction_verbose >= 3) oracle_trace_print(trace, 32);
+    if (path && oracle_trace_dump(trace, path) == 0)
+        printf("Dumped %zu oracle calls to %s\n", oracle_trace_count(trace), path);
+    oracle_trace_free(trace);
+}
+
+/*
+* Checkpoint sweep: warm the pool up, take a gem5 checkpoint when asked to, then
+* run one reduction per line of the parameter file on a shuffled copy of the pool.
+* Every restore of the checkpoint starts here, with the parameters of that restore.
+* @oracle: the counted oracle, before any voting wrapper
+*/
+static int run_sweep(const address_set_t *candidates, const cache_config_t *cfg,
+                     eviction_test_func_t oracle, test_context_t *ctx,
+                     oracle_stats_t *stats, const sweep_run_t *defaults,
+                     int checkpoint, const char *sweep_file, int simulated)
+{
+    oracle(candidates, ctx);
+    if (checkpoint) {
+        printf("\n=== Checkpoint after setup ===\n");
+        fflush(stdout);
+        m5_checkpoint(0, 0);
+        // Caches are not part of the checkpoint: warm them up again after a restore
+        oracle(candidates, ctx);
+    }
+
+    sweep_run_t runs[SWEEP_MAX_RUNS];
+    char *text = read_sweep_file(sweep_file);
+    int n = text ? parse_sweep_file(text, defaults, runs, SWEEP_MAX_RUNS) : 0;
+    free(text);
+    if (n < 0) return -1;
+    if (n == 0) {
+        printf("No sweep parameters, running the defaults once\n");
+        runs[0] = *defaults;
+        n = 1;
+    }
+
+    uintptr_t *order = malloc(candidates->size * sizeof(uintptr_t));
+    if (!order) {
+        perror("malloc sweep pool");
+        exit(1);
+    }
+
+    printf("\n=== Sweep: %d run%s over %zu candidates ===\n", n, n == 1 ? "" : "s", candidates->size);
+    printf("%4s %8s %7s %-12s %4s %6s %5s %3s %8s %10s %12s\n", "run", "seed", "reducer",
+           "pattern", "vote", "prefix", "size", "ok", "calls", "loads", "sim_ns");
+
+    int verbose = reduction_verbose;
+    const traversal_pattern_t *pattern = ctx->pattern;
+    int all_ok = 1;
+    for (int r = 0; r < n; r++) {
+        const sweep_run_t *run = &runs[r];
+        reduction_verbose = run->verbose;
+        ctx->pattern = run->use_pattern ? &run->pattern : pattern;
+
+        eviction_test_func_t test = oracle;
+        voting_oracle_t voting;
+        ctx->vote = NULL;
+        if (run->vote) {
+            // Fresh counters, the parameters main configured
+            voting = *run->voting;
+            voting.decisions = voting.samples = voting.forced = 0;
+            voting_oracle_configure(&voting);
+            test = voting_oracle_wrap(&voting, oracle);
+            ctx->vote = &voting;
+        }
+
+        // Same pool, order drawn from the run's seed
+        prng_t rng;
+        prng_seed(&rng, run->seed);
+        memcpy(order, candidates->addresses, candidates->size * sizeof(uintptr_t));
+        for (size_t i = candidates->size - 1; i > 0; i--) {
+            size_t j = prng_below(&rng, i + 1);
+            uintptr_t tmp = order[i];
+            order[i] = order[j];
+            order[j] = tmp;
+        }
+        address_set_t pool = address_set_view(order, candidates->size);
+
+        oracle_stats_reset(stats);
+        uint64_t start_ns = simulated ? m5_rpns() : 0;
+        address_set_t minimal = run->prefix ? prefix_reduction(run->reducer, &pool, cfg, test, ctx)
+                                            : run->reducer(&pool, cfg, test, ctx);
+        uint64_t sim_ns = simulated ? m5_rpns() - start_ns : 0;
+        // The verifying test below is not part of the run
+        uint64_t calls = stats->calls, loads = stats->loads;
+        int ok = minimal.size == cfg->associativity && test(&minimal, ctx);
+        all_ok &= ok;
+
+        char name[32] = "1:0:fwd";
+        if (ctx->pattern) format_traversal_pattern(ctx->pattern, name, sizeof(name));
+        printf("%4d %8u %7s %-12s %4d %6d %5zu %3s %8lu %10lu %12lu\n", r, run->seed,
+               run->reducer_name, name, run->vote, run->prefix, minimal.size, ok ? "yes" : "no",
+               (unsigned long)calls, (unsigned long)loads, (unsigned long)sim_ns);
+        free_address_set(&minimal);
+    }
+
+    ctx->vote = NULL;
+    ctx->pattern = pattern;
+    reduction_verbose = verbose;
+    free(order);
+    return all_ok ? 0 : -1;
+}
+
 int main(int argc, char **argv)
 {
     unsigned seed = 12345;
     int tries = 5;
+    const char *oracle_name = "m5";
+    replacement_policy_t policy = REPL_LRU;
+    const char *reducer_name = "tgt";
+    reduction_func_t reducer = threshold_group_reduction;
+    traversal_mode_t traversal = TRAVERSE_ARRAY;
+    size_t map_pool = 0;
+    int vote = 0;
+    voting_oracle_t voting;
+    const char *calibration_file = NULL;
+    int skip_calibration = 0;
+    int hugepages = 0;
+    int use_pagemap = 0;
+    cache_hierarchy_t hier = cache_hierarchy_default();
+    int level = 2;
+    slice_hash_t slice_hash = {0};
+    slice_hash_t model_slice_hash = {0};
+    size_t infer_pool = 0;
+    traversal_pattern_t pattern = { 1, 0, TRAVERSE_FORWARD };
+    int use_pattern = 0;
+    const char *trace_path = NULL;
+    size_t trace_size = 65536;
+    int checkpoint = 0;
+    const char *sweep_file = NULL;
+    int profiling = 0;
+    int use_prefix = 1;
+    const char *store_path = NULL;
+    size_t store_sets = 0;
+    size_t store_pool = 128;
+
+    // --vote-alpha / --vote-beta adjust the defaults, configured once parsing is done
+    voting_oracle_init(&voting);
 
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "--tries") == 0 && i + 1 < argc) {
             tries = atoi(argv[++i]);
         } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
             seed = (unsigned)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--oracle") == 0 && i + 1 < argc) {
+            oracle_name = argv[++i];
+        } else if (strcmp(argv[i], "--policy") == 0 && i + 1 < argc) {
+            if (!parse_replacement_policy(argv[++i], &policy)) {
+                fprintf(stderr, "Unknown replacement policy: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--reducer") == 0 && i + 1 < argc) {
+            reducer_name = argv[++i];
+            if (strcmp(reducer_name, "tgt") == 0) {
+                reducer = threshold_group_reduction;
+            } else if (strcmp(reducer_name, "tgt-static") == 0) {
+                reducer = static_group_reduction;
+            } else if (strcmp(reducer_name, "bs") == 0) {
+                reducer = binary_search_reduction;
+            } else {
+                fprintf(stderr, "Unknown reducer: %s\n", reducer_name);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--chase") == 0) {
+            traversal = TRAVERSE_CHASE;
+        } else if (strcmp(argv[i], "--pattern") == 0 && i + 1 < argc) {
+            if (!parse_traversal_pattern(argv[++i], &pattern)) {
+                fprintf(stderr, "Bad traversal pattern: %s\n", argv[i]);
+                return 1;
+            }
+            use_pattern = 1;
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (strcmp(argv[i], "--trace-size") == 0 && i + 1 < argc) {
+            trace_size = (size_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--checkpoint") == 0) {
+            checkpoint = 1;
+        } else if (strcmp(argv[i], "--sweep-file") == 0 && i + 1 < argc) {
+            sweep_file = argv[++i];
+        } else if (strcmp(argv[i], "--no-prefix") == 0) {
+            use_prefix = 0;
+        } else if (strcmp(argv[i], "--profile") == 0) {
+            profiling = 1;
+        } else if (strcmp(argv[i], "--verbose") == 0 && i + 1 < argc) {
+            reduction_verbose = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--map") == 0 && i + 1 < argc) {
+            map_pool = (size_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--store") == 0 && i + 1 < argc) {
+            store_path = argv[++i];
+        } else if (strcmp(argv[i], "--store-sets") == 0 && i + 1 < argc) {
+            store_sets = (size_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--store-pool") == 0 && i + 1 < argc) {
+            store_pool = (size_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--calibration") == 0 && i + 1 < argc) {
+            calibration_file = argv[++i];
+        } else if (strcmp(argv[i], "--skip-calibration") == 0) {
+            skip_calibration = 1;
+        } else if (strcmp(argv[i], "--hugepages") == 0) {
+            hugepages = 1;
+        } else if (strcmp(argv[i], "--pagemap") == 0) {
+            use_pagemap = 1;
+        } else if (strcmp(argv[i], "--hierarchy") == 0 && i + 1 < argc) {
+            const char *spec = argv[++i];
+            int ok = strcmp(spec, "sysfs") == 0 ? cache_hierarchy_from_sysfs(&hier)
+                                                : parse_cache_hierarchy(spec, &hier);
+            if (!ok) {
+                fprintf(stderr, "Bad cache hierarchy: %s\n", spec);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--level") == 0 && i + 1 < argc) {
+            level = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--slice-hash") == 0 && i + 1 < argc) {
+            if (!parse_slice_hash(argv[++i], &slice_hash)) {
+                fprintf(stderr, "Bad slice hash: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--model-slice-hash") == 0 && i + 1 < argc) {
+            if (!parse_slice_hash(argv[++i], &model_slice_hash)) {
+                fprintf(stderr, "Bad slice hash: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--infer-slices") == 0 && i + 1 < argc) {
+            infer_pool = (size_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--vote") == 0) {
+            vote = 1;
+        } else if (strcmp(argv[i], "--vote-alpha") == 0 && i + 1 < argc) {
+            vote = 1;
+            voting.alpha = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--vote-beta") == 0 && i + 1 < argc) {
+            vote = 1;
+            voting.beta = atof(argv[++i]);
         } else if (strcmp(argv[i], "--help") == 0) {
-            printf("Usage: %s [--tries <N>] [--seed <S>]\n", argv[0]);
+            printf("Usage: %s [--tries <N>] [--seed <S>] [--oracle m5|model|timing]"
+                   " [--policy lru|plru|random|rrip] [--reducer tgt|tgt-static|bs] [--chase]"
+                   " [--pattern <r:w:dir>] [--map <pool pages>] [--vote] [--vote-alpha <A>] [--vote-beta <B>]"
+                   " [--calibration <file>] [--skip-calibration] [--hugepages]"
+                   " [--pagemap] [--hierarchy <spec>|sysfs] [--level <N>]"
+                   " [--slice-hash <m0,m1,..>] [--model-slice-hash <m0,..>]"
+                   " [--infer-slices <pool>] [--trace <file>] [--trace-size <N>]"
+                   " [--verbose <0-3>] [--checkpoint] [--sweep-file <file>]"
+                   " [--profile] [--no-prefix] [--store <file>] [--store-sets <N>]"
+                   " [--store-pool <N>]\n", argv[0]);
+            printf("  --oracle model  answers eviction tests with the software cache model\n");
+            printf("                  (native runs, --policy selects its replacement policy)\n");
+            printf("  --oracle timing times the target reload against calibrated thresholds\n");
+            printf("                  (any x86 machine or stock gem5 CPU)\n");
+            printf("  --calibration F load the timing calibration from F, or calibrate and save it\n");
+            printf("  --skip-calibration  trust a loaded calibration without the quick recheck\n");
+            printf("  --reducer bs    binary-search element-wise reduction instead of\n");
+            printf("                  threshold group testing (tgt)\n");
+            printf("  --reducer tgt-static  tgt compiled for the build's associativity (make\n");
+            printf("                  STATIC_WAYS=N, default 8), tgt at any other\n");
+            printf("  --chase         reduce over a pointer chain stored in the candidate lines\n");
+            printf("  --pattern P     oracle traversal: repeat every window of w lines r times,\n");
+            printf("                  dir fwd|bwd|zigzag, w = 0 for the whole set (see m5_policy_probe)\n");
+            printf("  --map N         find eviction sets for every cache set from one pool of\n");
+            printf("                  N pages and write them to evmap_dump.txt\n");
+            printf("  --store F       warm start from the eviction set store F: re-create its\n");
+            printf("                  region, check every stored set with one oracle call,\n");
+            printf("                  reduce the failed and missing ones and rewrite F\n");
+            printf("  --store-sets N  sets kept in the store, from set 0 up (default: all of the level)\n");
+            printf("  --store-pool N  strides in the store region, each set reduces from the N - 1\n");
+            printf("                  others (default 128); part of the store key\n");
+            printf("  --hugepages     target and candidates in 2 MiB pages, so that their\n");
+            printf("                  physical set-index bits are known to match\n");
+            printf("  --pagemap       keep only candidates whose physical set index matches the\n");
+            printf("                  target's (needs a readable /proc/self/pagemap)\n");
+            printf("  --hierarchy S   cache levels from L1 down as size/ways[/line][/i][/sN],...\n");
+            printf("                  (i: inclusive, sN: N slices), or sysfs to read them from\n");
+            printf("                  the host; default 32K/8,256K/8\n");
+            printf("  --level N       cache level the eviction set targets (default 2)\n");
+            printf("  --slice-hash M  keep only candidates in the target's slice, bit b of the\n");
+            printf("                  slice being parity(pa & M[b]) (hex masks)\n");
+            printf("  --model-slice-hash M  slice the cache model oracle with that hash\n");
+            printf("  --infer-slices N  group N candidates by slice through the oracle, solve\n");
+            printf("                  for the XOR slice hash of the level and print it\n");
+            printf("  --trace F       record every oracle call in memory and write them to F at\n");
+            printf("                  exit (CSV when F ends in .csv, binary otherwise)\n");
+            printf("  --trace-size N  records kept, the oldest are overwritten (default 65536)\n");
+            printf("  --checkpoint    take a gem5 checkpoint once the pool evicts, then run the\n");
+            printf("                  sweep below: each restore reads its own parameters\n");
+            printf("  --sweep-file F  sweep parameters, one run per line of key=value words\n");
+            printf("                  (seed, reducer, pattern, vote, prefix, verbose=0); read with\n");
+            printf("                  m5_read_file() when omitted (see m5_sweep.sh)\n");
+            printf("  --no-prefix     reduce the whole evicting pool, not only its shortest\n");
+            printf("                  evicting prefix\n");
+            printf("  --profile       per-phase cost table (cycles, wall and simulated time,\n");
+            printf("                  oracle calls) and per-round reduction costs; the m5\n");
+            printf("                  oracle also dumps the gem5 stats once per phase and round\n");
+            printf("  --verbose N     0: quiet, 1: summaries (default), 2: every reduction step,\n");
+            printf("                  3: also the last oracle calls at exit\n");
+            printf("  --vote          repeat ambiguous eviction tests (sequential probability\n");
+            printf("                  ratio test) instead of trusting a single traversal\n");
+            printf("  --vote-alpha A  bound on a wrong \"evicts\" answer of --vote (default 0.005,\n");
+            printf("                  positives are confirmed by a second test below 0.0099)\n");
+            printf("  --vote-beta B   bound on a wrong \"does not evict\" answer (default 0.06)\n");
             return 0;
         } else {
             fprintf(stderr, "Unknown option: %s\n", argv[i]);
@@ -36,46 +363,249 @@ int main(int argc, char **argv)
 
     srand(seed);
 
-    cache_config_t cfg = {
-        .associativity   = 8,
-        .cache_line_size = 64,
-        .page_size       = 4096,
-        .l2_size         = 256 * 1024
-    };
+    if (level < 1 || (size_t)level > hier.num_levels) {
+        fprintf(stderr, "Level %d is not in the %zu-level hierarchy\n", level, hier.num_levels);
+        return 1;
+    }
+    printf("Cache hierarchy (targeting L%d):\n", level);
+    print_cache_hierarchy(&hier);
 
-    // Context: only target_address is used by the m5-op oracle
+    // Stride, pool and associativity of the targeted level
+    cache_config_t cfg = cache_level_config(&hier, level, 4096);
+    size_t level_sets = cfg.l2_size / (cfg.associativity * cfg.cache_line_size);
+    if (level_sets & (level_sets - 1)) {
+        fprintf(stderr, "L%d has %zu sets per slice, not a power of two: give its slice count"
+                        " with --hierarchy\n", level, level_sets);
+        return 1;
+    }
+
+    // Context: target_address for every oracle, oracle_state for the cache model
     test_context_t ctx = {0};
+    cache_model_t *model = NULL;
+    oracle_stats_t stats = {0};
+    oracle_trace_t trace = {0};
+    phase_profile_t profile;
+    phase_profile_t *prof = NULL;
 
-    uint8_t *target = (uint8_t*)aligned_alloc(cfg.cache_line_size, 64);
+    int target_huge = 0;
+    uint8_t *target = hugepages ? (uint8_t*)map_hugepage_region(HUGE_PAGE_SIZE, &target_huge)
+                                : (uint8_t*)aligned_alloc(cfg.cache_line_size, 64);
     if (!target) {
         perror("aligned_alloc");
         return 1;
     }
     memset(target, 0xAB, 64);
     ctx.target_address = target;
+    ctx.traversal = traversal;
+    ctx.pattern = use_pattern ? &pattern : NULL;
+    ctx.target_level = level;
+    ctx.calibration_file = calibration_file;
+    ctx.skip_calibration = skip_calibration;
+
+    // Every phase from here on is profiled: simulated time only exists under the m5 oracle
+    if (profiling) {
+        phase_profile_init(&profile, strcmp(oracle_name, "m5") == 0, &stats);
+        prof = &profile;
+        ctx.profile = prof;
+    }
+    phase_begin(prof, "setup");
+
+    eviction_test_func_t oracle;
+    batch_eviction_test_func_t batch_oracle;
+    if (strcmp(oracle_name, "m5") == 0) {
+        oracle = create_eviction_tester();
+        batch_oracle = create_batch_eviction_tester();
+    } else if (strcmp(oracle_name, "model") == 0) {
+        model = cache_model_create(&cfg, policy, seed);
+        if (!model) {
+            release_target(target, hugepages);
+            return 1;
+        }
+        if (model_slice_hash.num_bits)
+            cache_model_set_slice_hash(model, &model_slice_hash);
+        ctx.oracle_state = model;
+        oracle = create_cache_model_tester();
+        batch_oracle = create_cache_model_batch_tester();
+        printf("Using software cache model oracle (%s replacement)\n",
+               replacement_policy_name(policy));
+    } else if (strcmp(oracle_name, "timing") == 0) {
+        // Calibrate against a level below L1, so that the L1 and the deeper threshold both exist
+        int cal_level = (level < 2 && hier.num_levels >= 2) ? 2 : level;
+        cache_config_t cal_cfg = cache_level_config(&hier, cal_level, 4096);
+        print_cache_timing(setup_cache_timing(&ctx, &cal_cfg));
+        oracle = create_timing_tester();
+        batch_oracle = create_timing_batch_tester();
+    } else {
+        fprintf(stderr, "Unknown oracle: %s\n", oracle_name);
+        release_target(target, hugepages);
+        return 1;
+    }
+
+    // Count every oracle call and load from here on
+    oracle = oracle_stats_wrap(&stats, oracle);
+    batch_oracle = oracle_stats_wrap_batch(&stats, batch_oracle);
+    ctx.stats = &stats;
+    eviction_test_func_t counted_oracle = oracle;
+
+    // Innermost: the oracles write one record per traversal, voted or not
+    if (trace_path || reduction_verbose >= 3) {
+        if (oracle_trace_init(&trace, trace_size ? trace_size : 1) != 0) {
+            perror("malloc oracle trace");
+            exit(1);
+        }
+        ctx.trace = &trace;
+    }
 
-    eviction_test_func_t oracle = create_eviction_tester();
+    // Votes go on top: stats keep counting every traversal, not every answer
+    if (vote) {
+        voting_oracle_configure(&voting);
+        oracle = voting_oracle_wrap(&voting, oracle);
+        ctx.vote = &voting;
+    }
 
     // Sanity: empty set should NOT evict (expect 0)
     address_set_t empty = create_address_set(1);
     empty.size = 0;
     printf("Empty-set eviction (expect 0): %d\n", oracle(&empty, &ctx));
     free_address_set(&empty);
+    phase_end(prof);
+    oracle_stats_reset(&stats);
+
+    if (map_pool) {
+        printf("\n=== Mapping every cache set from %zu pages ===\n", map_pool);
+        oracle_stats_reset(&stats);
+        phase_begin(prof, "map");
+        eviction_map_t map = build_eviction_map(&cfg, map_pool, reducer, oracle,
+                                                batch_oracle, &ctx);
+        phase_end(prof);
+
+        size_t mapped = 0;
+        for (size_t s = 0; s < map.num_slots; s++)
+            mapped += (map.sets[s].size == cfg.associativity);
+        printf("Mapped %zu/%zu sets (%zu colors x %zu lines per page)\n",
+               mapped, map.num_slots, map.colors, map.lines_per_page);
+        oracle_stats_print(&stats, "Mapping");
+
+        if (dump_eviction_map(&map, &cfg, "evmap_dump.txt") == 0)
+            printf("Dumped eviction set map to evmap_dump.txt\n");
+
+        free_eviction_map(&map);
+        if (prof) phase_profile_print(prof);
+        finish_trace(&trace, trace_path);
+        cache_model_destroy(model);
+        free(ctx.calibration_data);
+        release_target(target, hugepages);
+        return mapped == map.num_slots ? 0 : -1;
+    }
+
+    if (store_path) {
+        printf("\n=== Eviction set store %s ===\n", store_path);
+        if (store_pool <= cfg.associativity) {
+            fprintf(stderr, "--store-pool must be larger than the associativity (%zu)\n",
+                    cfg.associativity);
+            return 1;
+        }
+        evset_region_t region;
+        evset_region_map(&region, &cfg, store_sets ? store_sets : level_sets, store_pool, hugepages);
+        address_set_t *sets = calloc(region.num_sets, sizeof(address_set_t));
+        if (!sets) {
+            perror("calloc store sets");
+            exit(1);
+        }
+
+        prng_t rng;
+        prng_seed(&rng, seed);
+        evset_store_stats_t st;
+        oracle_stats_reset(&stats);
+        phase_begin(prof, "store");
+        size_t found = evset_store_sync(store_path, &region, &cfg, level, reducer, use_prefix,
+                                        oracle, &ctx, &rng, sets, &st);
+        phase_end(prof);
+        printf("%zu/%zu sets: %zu of %zu stored still evict, %zu reduced, %zu missing"
+               " (%.1f ms)\n", found, region.num_sets, st.valid, st.loaded, st.reduced,
+               st.missing, st.elapsed_ms);
+        oracle_stats_print(&stats, "Store");
+        // Physically indexed: only one stride in stride / page shares the target's set
+        if (st.missing)
+            printf("%zu sets found no eviction set in %zu strides, try a larger --store-pool\n",
+                   st.missing, region.pool_lines);
+
+        for (size_t s = 0; s < region.num_sets; s++) free_address_set(&sets[s]);
+        free(sets);
+        evset_region_unmap(&region);
+        if (prof) phase_profile_print(prof);
+        finish_trace(&trace, trace_path);
+        cache_model_destroy(model);
+        free(ctx.calibration_data);
+        release_target(target, hugepages);
+        return found == region.num_sets ? 0 : -1;
+    }
+
+    // Address bits a slice hash can read: the model indexes virtual addresses
+    slice_bits_t slice_bits = SLICE_BITS_PAGEMAP;
+    if (model)
+        slice_bits = SLICE_BITS_VIRTUAL;
+    else if (!virt_to_phys(target) && hugepages)
+        slice_bits = SLICE_BITS_HUGEPAGE;
+
+    if (infer_pool) {
+        size_t slices = hier.levels[level - 1].slices;
+        printf("\n=== Inferring the L%d slice hash (%zu slices) ===\n", level, slices);
+        if (slices < 2) {
+            fprintf(stderr, "L%d is not sliced: give its slice count with --hierarchy\n", level);
+        } else {
+            address_set_t pool = hugepages
+                ? generate_hugepage_candidate_set(target, infer_pool, target_huge, &cfg, NULL)
+                : generate_candidate_set(target, infer_pool, &cfg);
+            if (slice_bits == SLICE_BITS_PAGEMAP)
+                physical_filter_candidates(&pool, target, &cfg);
+
+            oracle_stats_reset(&stats);
+            slice_hash_t inferred;
+            phase_begin(prof, "slice inference");
+            size_t bits = infer_slice_hash(&cfg, slices, &pool, slice_bits, reducer, oracle,
+                                           batch_oracle, &ctx, &inferred);
+            phase_end(prof);
+            oracle_stats_print(&stats, "Slice inference");
+            if (bits) print_slice_hash(&inferred);
+            else printf("No slice hash found\n");
+            free_address_set(&pool);
+        }
+
+        if (prof) phase_profile_print(prof);
+        finish_trace(&trace, trace_path);
+        cache_model_destroy(model);
+        free(ctx.calibration_data);
+        release_target(target, hugepages);
+        return 0;
+    }
 
     int evicts = 0;
     address_set_t candidates = (address_set_t){0};
 
-    int nb_candidate = 128;
+    size_t nb_candidate = 128;
     do {
-        if (candidates.addresses)
-            free_address_set(&candidates);
-
         printf("\n=== Step 1: Generate candidate addresses ===\n");
-        candidates = generate_candidate_set(target, nb_candidate, &cfg);
+        phase_begin(prof, "generation");
+        // Grow the pool in place: the candidates already placed are kept
+        if (!candidates.addresses && hugepages)
+            candidates = generate_hugepage_candidate_set(target, 2 * cfg.associativity,
+                                                         target_huge, &cfg, NULL);
+        else if (!candidates.addresses)
+            candidates = generate_candidate_set(target, nb_candidate, &cfg);
+        else  // nb_candidate was doubled: add the other half
+            grow_candidate_set(&candidates, target, nb_candidate / 2, &cfg, NULL);
         printf("Generated %zu candidates.\n", candidates.size);
 
-        printf("\n=== Step 2: Test candidate pool (m5-op oracle) ===\n");
+        if (use_pagemap)
+            physical_filter_candidates(&candidates, target, &cfg);
+        if (slice_hash.num_bits)
+            slice_filter_candidates(&candidates, target, &slice_hash, slice_bits);
+
+        printf("\n=== Step 2: Test candidate pool (%s oracle) ===\n", oracle_name);
+        phase_begin(prof, "pool test");
         evicts = oracle(&candidates, &ctx);
+        phase_end(prof);
         printf("Candidate pool eviction: %s\n", evicts ? "✅ YES (evicts)" : "❌ NO (does not evict)");
 
         if (!evicts) {
@@ -87,23 +617,55 @@ int main(int argc, char **argv)
 
     if (!evicts) {
         printf("Could not find an initial eviction set. Increase candidates/stride.\n");
+        if (prof) phase_profile_print(prof);
         free_address_set(&candidates);
-        free(target);
+        finish_trace(&trace, trace_path);
+        cache_model_destroy(model);
+        free(ctx.calibration_data);
+        release_target(target, hugepages);
         return -1;
     }
 
-    printf("\n=== Step 3: Threshold Group Reduction ===\n");
-    address_set_t minimal = threshold_group_reduction(&candidates, &cfg, oracle, &ctx);
+    oracle_stats_print(&stats, "Candidate pool search");
+    oracle_stats_reset(&stats);
+
+    if (checkpoint || sweep_file) {
+        // Quiet runs unless a line asks otherwise, the table is the output
+        sweep_run_t defaults = { seed, reducer_name, reducer, pattern, use_pattern, vote,
+                                 &voting, use_prefix, 0 };
+        phase_begin(prof, "sweep");
+        int rc = run_sweep(&candidates, &cfg, counted_oracle, &ctx, &stats, &defaults,
+                           checkpoint, sweep_file, strcmp(oracle_name, "m5") == 0);
+        phase_end(prof);
+        if (prof) phase_profile_print(prof);
+        finish_trace(&trace, trace_path);
+        free_address_set(&candidates);
+        cache_model_destroy(model);
+        free(ctx.calibration_data);
+        release_target(target, hugepages);
+        return rc;
+    }
+
+    printf("\n=== Step 3: Reduction (%s) ===\n", reducer_name);
+    phase_begin(prof, "reduction");
+    address_set_t minimal = use_prefix ? prefix_reduction(reducer, &candidates, &cfg, oracle, &ctx)
+                                       : reducer(&candidates, &cfg, oracle, &ctx);
+    phase_end(prof);
+    oracle_stats_print(&stats, "Reduction");
+    if (vote) voting_oracle_print(&voting);
 
     printf("\nReduction complete.\n");
     printf("  Original size: %zu\n", candidates.size);
     printf("  Minimal set size: %zu\n", minimal.size);
 
     printf("\n=== Step 4: Verification ===\n");
+    phase_begin(prof, "verification");
     int still_evicts = oracle(&minimal, &ctx);
+    phase_end(prof);
     printf("Verification: %s\n", still_evicts ? "✅ Still evicts" : "❌ No longer evicts");
 
     printf("\n=== Step 5: Leave-One-Out minimality test ===\n");
+    phase_begin(prof, "leave-one-out");
     uintptr_t *min_addrs = (uintptr_t*)malloc(minimal.size * sizeof(uintptr_t));
     if (!min_addrs) { perror("malloc min_addrs"); goto cleanup; }
     for (size_t i = 0; i < minimal.size; ++i) min_addrs[i] = minimal.addresses[i];
@@ -125,7 +687,10 @@ int main(int argc, char **argv)
     }
     free(min_addrs);
 
+    phase_end(prof);
+
     printf("\n=== Step 6: Dump eviction set ===\n");
+    phase_begin(prof, "dump");
     {
         FILE *f = fopen("evset_dump.txt", "w");
         if (!f) {
@@ -147,9 +712,8 @@ int main(int argc, char **argv)
             fprintf(f, "# offsets (hex)  then virtual addresses\n");
 
             if (candidates.backing) {
-                uintptr_t pool_base = (uintptr_t)candidates.backing;
                 for (size_t i = 0; i < minimal.size; ++i) {
-                    uintptr_t off = minimal.addresses[i] - pool_base;
+                    uintptr_t off = pool_offset(&candidates, minimal.addresses[i]);
                     fprintf(f, "0x%zx  0x%lx\n", off, (unsigned long)minimal.addresses[i]);
                 }
             } else {
@@ -162,9 +726,14 @@ int main(int argc, char **argv)
     }
 
 cleanup:
+    phase_end(prof);
+    if (prof) phase_profile_print(prof);
+    finish_trace(&trace, trace_path);
     free_address_set(&minimal);
     free_address_set(&candidates);
-    free(target);
+    cache_model_destroy(model);
+    free(ctx.calibration_data);
+    release_target(target, hugepages);
     printf("\n=== Done ===\n");
     return 0;
 }
@@ -0,0 +1,57 @@
+#!/bin/sh
+# Parameter sweep over one m5_evic checkpoint in gem5 SE mode.
+#
+#   m5_sweep.sh setup  <checkpoint dir> [m5_evic options...]
+#       run m5_evic once with --checkpoint: setup, pool search and warm-up are
+#       simulated here only, the checkpoint lands in <checkpoint dir>
+#   m5_sweep.sh run    <checkpoint dir> <params file>...
+#       restore that checkpoint once per parameter file; the file is copied to
+#       $SWEEP_FILE first, which the restored m5_evic reads (SE opens host files)
+#
+# Parameter files hold one reduction per line, e.g. "seed=3 reducer=bs pattern=2:0:zigzag".
+# The m5_evic options of both steps must match: gem5 restores the same process.
+
+GEM5_HOME=${GEM5_HOME:-$HOME/gem5-Okapi}
+GEM5=${GEM5:-$GEM5_HOME/build/X86/gem5.opt}
+CONFIG=${CONFIG:-$GEM5_HOME/configs/deprecated/example/se.py}
+BIN=${BIN:-bin/m5_evic}
+SWEEP_FILE=${SWEEP_FILE:-/tmp/m5_evic_sweep.txt}
+GEM5_OPTS=${GEM5_OPTS:---caches --l2cache}
+
+usage() {
+    echo "Usage: $0 setup <checkpoint dir> [m5_evic options...]" >&2
+    echo "       $0 run <checkpoint dir> <params file>..." >&2
+    exit 1
+}
+
+[ $# -ge 2 ] || usage
+mode=$1
+ckpt=$2
+shift 2
+
+case $mode in
+setup)
+    mkdir -p "$ckpt"
+    echo "$*" > "$ckpt/m5_evic.options"
+    : > "$SWEEP_FILE"
+    exec "$GEM5" --outdir="$ckpt/setup" "$CONFIG" $GEM5_OPTS \
+        --checkpoint-dir="$ckpt" --cmd="$BIN" \
+        --options="--checkpoint --sweep-file $SWEEP_FILE $*"
+    ;;
+run)
+    [ $# -ge 1 ] || usage
+    opts=$(cat "$ckpt/m5_evic.options")
+    for params in "$@"; do
+        name=$(basename "$params")
+        cp "$params" "$SWEEP_FILE" || exit 1
+        echo "=== $name ==="
+        "$GEM5" --outdir="$ckpt/run_${name%.*}" "$CONFIG" $GEM5_OPTS \
+            --checkpoint-dir="$ckpt" -r 1 --cmd="$BIN" \
+            --options="--checkpoint --sweep-file $SWEEP_FILE $opts" || exit 1
+        sed -n '/=== Sweep/,$p' "$ckpt/run_${name%.*}/simout" 2>/dev/null
+    done
+    ;;
+*)
+    usage
+    ;;
+esac
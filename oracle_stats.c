@@ -0,0 +1,104 @@
+#include "oracle_stats.h"
+#include "traversal.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static size_t size_bucket(size_t size)
+{
+    size_t k = 0;
+    while (size > 1 && k < ORACLE_STATS_SIZE_BUCKETS - 1) {
+        size >>= 1;
+        k++;
+    }
+    return k;
+}
+
+void oracle_stats_record(oracle_stats_t *stats, const address_set_t *set,
+                         const test_context_t *context, int positive)
+{
+    size_t set_size = set->size;
+
+    stats->calls++;
+    stats->positives += positive ? 1 : 0;
+    stats->loads += traversal_pattern_loads(context->pattern, set_size, set->chain != 0);
+    stats->set_size_sum += set_size;
+    if (set_size < stats->min_set_size) stats->min_set_size = set_size;
+    if (set_size > stats->max_set_size) stats->max_set_size = set_size;
+    stats->size_hist[size_bucket(set_size)]++;
+}
+
+static int counting_eviction_test(const address_set_t *set,
+                                  const test_context_t *context)
+{
+    oracle_stats_t *stats = context->stats;
+    int result = stats->inner(set, context);
+
+    oracle_stats_record(stats, set, context, result);
+    return result;
+}
+
+static uint64_t counting_batch_eviction_test(const address_set_t *set,
+                                             void *const *targets,
+                                             size_t num_targets,
+                                             const test_context_t *context)
+{
+    oracle_stats_t *stats = context->stats;
+    uint64_t result = stats->batch_inner(set, targets, num_targets, context);
+
+    oracle_stats_record(stats, set, context, result != 0);
+    stats->batch_targets += num_targets;
+    return result;
+}
+
+eviction_test_func_t oracle_stats_wrap(oracle_stats_t *stats, eviction_test_func_t inner)
+{
+    oracle_stats_reset(stats);
+    stats->inner = inner;
+    return counting_eviction_test;
+}
+
+batch_eviction_test_func_t oracle_stats_wrap_batch(oracle_stats_t *stats,
+                                                   batch_eviction_test_func_t inner)
+{
+    stats->batch_inner = inner;
+    return counting_batch_eviction_test;
+}
+
+eviction_test_func_t oracle_stats_unwrap(eviction_test_func_t test_func,
+                                         const test_context_t *context)
+{
+    if (context->stats && test_func == counting_eviction_test) return context->stats->inner;
+    return test_func;
+}
+
+void oracle_stats_reset(oracle_stats_t *stats)
+{
+    eviction_test_func_t inner = stats->inner;
+    batch_eviction_test_func_t batch_inner = stats->batch_inner;
+    memset(stats, 0, sizeof(*stats));
+    stats->inner = inner;
+    stats->batch_inner = batch_inner;
+    stats->min_set_size = SIZE_MAX;
+}
+
+void oracle_stats_print(const oracle_stats_t *stats, const char *name)
+{
+    printf("%s: %lu oracle calls (%lu evicting), %lu candidate loads, %lu retries\n",
+           name, (unsigned long)stats->calls, (unsigned long)stats->positives,
+           (unsigned long)stats->loads, (unsigned long)stats->retries);
+    if (!stats->calls) return;
+
+    if (stats->batch_targets)
+        printf("  batched calls resolved %lu targets\n", (unsigned long)stats->batch_targets);
+
+    printf("  set size: min=%zu max=%zu mean=%.1f\n",
+           stats->min_set_size, stats->max_set_size,
+           (double)stats->set_size_sum / (double)stats->calls);
+    for (size_t k = 0; k < ORACLE_STATS_SIZE_BUCKETS; k++) {
+        if (!stats->size_hist[k]) continue;
+        printf("  [%6zu, %6zu) %lu calls\n",
+               k ? ((size_t)1 << k) : 0, (size_t)1 << (k + 1),
+               (unsigned long)stats->size_hist[k]);
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef ORACLE_STATS_H
+#define ORACLE_STATS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "threshold_group_testing.h"
+
+#define ORACLE_STATS_SIZE_BUCKETS 32
+
+/*
+* Accounting of eviction test calls.
+* The wrapper returned by oracle_stats_wrap() forwards to @inner and finds
+* this struct through context->stats, so every context can carry its own counters.
+*/
+typedef struct oracle_stats {
+    eviction_test_func_t inner;
+    batch_eviction_test_func_t batch_inner;
+
+    uint64_t calls;
+    uint64_t positives;      // calls that answered "evicts"
+    uint64_t loads;          // candidate addresses traversed over all calls
+    uint64_t set_size_sum;   // sizes of the tested sets over all calls
+    size_t   min_set_size;
+    size_t   max_set_size;
+    uint64_t retries;        // groups re-inserted by the reducer when backtracking
+    uint64_t batch_targets;  // targets resolved by batched calls (each batched call counts once)
+
+    // size_hist[k] counts calls with a set size in [2^k, 2^(k+1)), empty sets in [0]
+    uint64_t size_hist[ORACLE_STATS_SIZE_BUCKETS];
+} oracle_stats_t;
+
+
+/*
+* Install @inner behind the accounting wrapper
+* @stats: Counters to fill, must also be stored in context->stats
+* Returns the wrapper to use in place of @inner
+*/
+eviction_test_func_t oracle_stats_wrap(oracle_stats_t *stats, eviction_test_func_t inner);
+
+// Same for the batched oracle, counted into the same @stats
+batch_eviction_test_func_t oracle_stats_wrap_batch(oracle_stats_t *stats,
+                                                   batch_eviction_test_func_t inner);
+
+/*
+* The oracle behind @test_func when it is the accounting wrapper of context->stats,
+* else @test_func itself: lets a reducer recognise an oracle it can inline
+*/
+eviction_test_func_t oracle_stats_unwrap(eviction_test_func_t test_func,
+                                         const test_context_t *context);
+
+// Count one call on @set, for an oracle inlined past the wrapper
+void oracle_stats_record(oracle_stats_t *stats, const address_set_t *set,
+                         const test_context_t *context, int positive);
+
+void oracle_stats_reset(oracle_stats_t *stats);
+void oracle_stats_print(const oracle_stats_t *stats, const char *name);
+
+#endif //ORACLE_STATS_H
@@ -0,0 +1,100 @@
+#include "oracle_trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t reserved;
+    uint64_t count;         // records that follow
+    uint64_t calls;         // calls traced, count < calls when the ring wrapped
+} oracle_trace_header_t;
+
+int oracle_trace_init(oracle_trace_t *trace, size_t capacity)
+{
+    size_t cap = 1;
+    while (cap < capacity) cap <<= 1;
+
+    trace->records = malloc(cap * sizeof(oracle_trace_record_t));
+    if (!trace->records) return -1;
+    // Fault every page in now, not on the first record of each page
+    memset(trace->records, 0, cap * sizeof(oracle_trace_record_t));
+    trace->capacity = cap;
+    trace->calls = 0;
+    return 0;
+}
+
+void oracle_trace_free(oracle_trace_t *trace)
+{
+    free(trace->records);
+    trace->records = NULL;
+    trace->capacity = 0;
+}
+
+static int has_suffix(const char *s, const char *suffix)
+{
+    size_t n = strlen(s), k = strlen(suffix);
+    return n >= k && strcmp(s + n - k, suffix) == 0;
+}
+
+int oracle_trace_dump(const oracle_trace_t *trace, const char *path)
+{
+    int csv = has_suffix(path, ".csv");
+    FILE *f = fopen(path, csv ? "w" : "wb");
+    if (!f) {
+        perror("fopen oracle trace");
+        return -1;
+    }
+
+    size_t count = oracle_trace_count(trace);
+    int ok = 1;
+    if (csv) {
+        fprintf(f, "call,kind,set_size,result,hit_level,tsc,ticks\n");
+        for (size_t i = 0; i < count; i++) {
+            const oracle_trace_record_t *r = oracle_trace_at(trace, i);
+            fprintf(f, "%lu,%s,%u,%u,%u,%lu,%lu\n", (unsigned long)r->call,
+                    r->kind == ORACLE_TRACE_BATCH ? "batch" : "single", r->set_size,
+                    r->result, r->hit_level, (unsigned long)r->tsc, (unsigned long)r->ticks);
+        }
+    } else {
+        oracle_trace_header_t h = {
+            ORACLE_TRACE_MAGIC, ORACLE_TRACE_VERSION,
+            sizeof(oracle_trace_record_t), 0, count, trace->calls
+        };
+        ok = fwrite(&h, sizeof(h), 1, f) == 1;
+        // At most two runs: from the oldest record to the end of the ring, then the start
+        size_t first = (size_t)((trace->calls - count) & (trace->capacity - 1));
+        size_t run = count < trace->capacity - first ? count : trace->capacity - first;
+        if (ok && run)
+            ok = fwrite(&trace->records[first], sizeof(oracle_trace_record_t), run, f) == run;
+        if (ok && count > run)
+            ok = fwrite(trace->records, sizeof(oracle_trace_record_t), count - run, f) == count - run;
+    }
+
+    if (fclose(f) != 0 || !ok) {
+        perror("write oracle trace");
+        return -1;
+    }
+    return 0;
+}
+
+void oracle_trace_print(const oracle_trace_t *trace, size_t last)
+{
+    size_t count = oracle_trace_count(trace);
+    size_t from = (last && last < count) ? count - last : 0;
+
+    printf("Oracle trace: %lu calls, last %zu:\n", (unsigned long)trace->calls, count - from);
+    printf("%10s %6s %8s %6s %5s %14s %14s\n",
+           "call", "kind", "set_size", "result", "level", "tsc delta", "ticks");
+    uint64_t prev_tsc = from < count ? oracle_trace_at(trace, from)->tsc : 0;
+    for (size_t i = from; i < count; i++) {
+        const oracle_trace_record_t *r = oracle_trace_at(trace, i);
+        printf("%10lu %6s %8u %6u %5u %14lu %14lu\n", (unsigned long)r->call,
+               r->kind == ORACLE_TRACE_BATCH ? "batch" : "single", r->set_size, r->result,
+               r->hit_level, (unsigned long)(r->tsc - prev_tsc), (unsigned long)r->ticks);
+        prev_tsc = r->tsc;
+    }
+}
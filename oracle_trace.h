@@ -0,0 +1,83 @@
+#ifndef ORACLE_TRACE_H
+#define ORACLE_TRACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <x86intrin.h>
+
+#include "threshold_group_testing.h"
+
+#define ORACLE_TRACE_MAGIC   0x43525445u   // "ETRC"
+#define ORACLE_TRACE_VERSION 1
+
+typedef enum {
+    ORACLE_TRACE_SINGLE = 0,
+    ORACLE_TRACE_BATCH
+} oracle_trace_kind_t;
+
+// One oracle call, 32 bytes, written to trace files as is
+typedef struct {
+    uint64_t call;          // call id, keeps counting past overwritten records
+    uint64_t tsc;           // rdtsc when the oracle answered
+    uint64_t ticks;         // simulated time from m5_rpns(), 0 outside the m5-op oracles
+    uint32_t set_size;
+    uint16_t result;        // 0/1, or the number of evicted targets of a batch call
+    uint8_t hit_level;      // target hit level, 0 when the oracle does not see it
+    uint8_t kind;           // oracle_trace_kind_t
+} oracle_trace_record_t;
+
+/*
+* Preallocated ring of the last `capacity` oracle calls.
+* Recording never allocates, locks or makes a syscall: the oracles can write
+* to it inside the measured sequence, unlike printf.
+*/
+typedef struct oracle_trace {
+    oracle_trace_record_t *records;
+    size_t capacity;        // power of two
+    uint64_t calls;
+} oracle_trace_t;
+
+/*
+* Allocate and pre-fault room for @capacity records (rounded up to a power of two)
+* Returns 0 on success, -1 if the allocation fails
+*/
+int oracle_trace_init(oracle_trace_t *trace, size_t capacity);
+void oracle_trace_free(oracle_trace_t *trace);
+
+// Called by the oracles on every answer, a NULL @trace records nothing
+static inline void oracle_trace_record(oracle_trace_t *trace, oracle_trace_kind_t kind,
+                                       size_t set_size, unsigned result,
+                                       unsigned hit_level, uint64_t ticks)
+{
+    if (!trace) return;
+    oracle_trace_record_t *r = &trace->records[trace->calls & (trace->capacity - 1)];
+    r->call = trace->calls++;
+    r->tsc = __rdtsc();
+    r->ticks = ticks;
+    r->set_size = (uint32_t)set_size;
+    r->result = (uint16_t)result;
+    r->hit_level = (uint8_t)hit_level;
+    r->kind = (uint8_t)kind;
+}
+
+// Records still held, oldest first: index i of the ring order is oracle_trace_at(trace, i)
+static inline size_t oracle_trace_count(const oracle_trace_t *trace) {
+    return trace->calls < trace->capacity ? (size_t)trace->calls : trace->capacity;
+}
+
+static inline const oracle_trace_record_t *oracle_trace_at(const oracle_trace_t *trace, size_t i) {
+    uint64_t first = trace->calls - oracle_trace_count(trace);
+    return &trace->records[(first + i) & (trace->capacity - 1)];
+}
+
+/*
+* Write the held records oldest first: CSV when @path ends in .csv, otherwise a
+* binary header (magic, version, record size, count, calls) followed by the records
+* Returns 0 on success, -1 on I/O error
+*/
+int oracle_trace_dump(const oracle_trace_t *trace, const char *path);
+
+// Print the last @last records (all of them when 0)
+void oracle_trace_print(const oracle_trace_t *trace, size_t last);
+
+#endif //ORACLE_TRACE_H
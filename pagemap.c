@@ -0,0 +1,125 @@
+#include "pagemap.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define PAGEMAP_PRESENT   (1ull << 63)
+#define PAGEMAP_PFN_MASK  ((1ull << 55) - 1)
+#define PAGEMAP_MAX_RUN   512   // entries per pread
+
+typedef struct {
+    uintptr_t vpn;
+    size_t index;
+} vpn_entry_t;
+
+static int cmp_vpn(const void *a, const void *b)
+{
+    uintptr_t x = ((const vpn_entry_t *)a)->vpn, y = ((const vpn_entry_t *)b)->vpn;
+    return (x > y) - (x < y);
+}
+
+long virt_to_phys_bulk(const uintptr_t *addresses, size_t n, uintptr_t *phys)
+{
+    int fd = open("/proc/self/pagemap", O_RDONLY);
+    if (fd < 0) return -1;
+
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    vpn_entry_t *order = malloc(n * sizeof(vpn_entry_t));
+    uint64_t *entries = malloc(PAGEMAP_MAX_RUN * sizeof(uint64_t));
+    if (!order || !entries) {
+        perror("malloc pagemap");
+        exit(1);
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        order[i].vpn = addresses[i] / page;
+        order[i].index = i;
+        phys[i] = 0;
+    }
+    qsort(order, n, sizeof(vpn_entry_t), cmp_vpn);
+
+    long translated = 0;
+    int pfn_visible = 0;
+    size_t i = 0;
+    while (i < n) {
+        // One read for the run of pages [first, first + count) holding order[i..]
+        uintptr_t first = order[i].vpn;
+        size_t j = i;
+        while (j < n && order[j].vpn - first < PAGEMAP_MAX_RUN) j++;
+        size_t count = order[j - 1].vpn - first + 1;
+
+        ssize_t got = pread(fd, entries, count * sizeof(uint64_t), (off_t)(first * sizeof(uint64_t)));
+        if (got != (ssize_t)(count * sizeof(uint64_t))) {
+            translated = -1;
+            break;
+        }
+
+        for (size_t k = i; k < j; k++) {
+            uint64_t e = entries[order[k].vpn - first];
+            if (!(e & PAGEMAP_PRESENT)) continue;
+            uint64_t pfn = e & PAGEMAP_PFN_MASK;
+            if (pfn) pfn_visible = 1;
+            size_t idx = order[k].index;
+            phys[idx] = (uintptr_t)(pfn * page) | (addresses[idx] & (page - 1));
+            translated++;
+        }
+        i = j;
+    }
+
+    close(fd);
+    free(entries);
+    free(order);
+
+    // Without CAP_SYS_ADMIN every PFN reads as 0
+    if (translated > 0 && !pfn_visible) return -1;
+    return translated;
+}
+
+uintptr_t virt_to_phys(const void *address)
+{
+    uintptr_t addr = (uintptr_t)address, phys = 0;
+    if (virt_to_phys_bulk(&addr, 1, &phys) != 1) return 0;
+    return phys;
+}
+
+int physical_filter_candidates(address_set_t *set, void *target_addr,
+                               const cache_config_t *cfg)
+{
+    size_t num_sets = cfg->l2_size / (cfg->cache_line_size * cfg->associativity);
+
+    // Fault the target in first, a page that was never touched has no frame
+    volatile uint8_t tmp = *(volatile uint8_t *)target_addr;
+    (void)tmp;
+
+    uintptr_t target_phys = virt_to_phys(target_addr);
+    if (!target_phys) {
+        TGT_LOG("[PhysFilter] pagemap unavailable, keeping all %zu candidates\n", set->size);
+        return 0;
+    }
+    size_t target_set = (target_phys / cfg->cache_line_size) % num_sets;
+
+    uintptr_t *phys = malloc(set->size * sizeof(uintptr_t));
+    if (!phys) {
+        perror("malloc physical addresses");
+        exit(1);
+    }
+    if (virt_to_phys_bulk(set->addresses, set->size, phys) < 0) {
+        TGT_LOG("[PhysFilter] pagemap unavailable, keeping all %zu candidates\n", set->size);
+        free(phys);
+        return 0;
+    }
+
+    size_t before = set->size, kept = 0;
+    for (size_t i = 0; i < before; i++) {
+        if (phys[i] && (phys[i] / cfg->cache_line_size) % num_sets == target_set)
+            set->addresses[kept++] = set->addresses[i];
+    }
+    set->size = kept;
+    free(phys);
+
+    TGT_LOG("[PhysFilter] kept %zu of %zu candidates (physical set %zu)\n",
+            kept, before, target_set);
+    return 1;
+}
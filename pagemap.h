@@ -0,0 +1,34 @@
+#ifndef PAGEMAP_H
+#define PAGEMAP_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "threshold_group_testing.h"
+
+/*
+* Virtual to physical translation through /proc/self/pagemap.
+* PFNs are only visible with CAP_SYS_ADMIN (or in a gem5 SE/FS image we control);
+* everywhere else the lookups fail and callers keep their virtual-address behavior.
+*/
+
+/*
+* Translate addresses[0..n) into phys[0..n), 0 for pages that are not present
+* Contiguous pages are read with one pread, in address order
+* Returns the number of addresses translated, -1 when pagemap is unreadable or hides PFNs
+*/
+long virt_to_phys_bulk(const uintptr_t *addresses, size_t n, uintptr_t *phys);
+
+// Physical address of one line, 0 when unknown
+uintptr_t virt_to_phys(const void *address);
+
+/*
+* Keep only the candidates whose physical set index matches @target_addr's
+* Order of the kept candidates is preserved
+* Returns 1 when the set was filtered, 0 when physical addresses are not
+* available and @set was left untouched
+*/
+int physical_filter_candidates(address_set_t *set, void *target_addr,
+                               const cache_config_t *cfg);
+
+#endif //PAGEMAP_H
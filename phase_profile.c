@@ -0,0 +1,134 @@
+#include "phase_profile.h"
+#include "oracle_stats.h"
+
+#include <gem5/m5ops.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <x86intrin.h>
+
+// Absolute counters, the cost of a region is the difference of two marks
+static void take_mark(const phase_profile_t *profile, phase_cost_t *mark)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    mark->wall_ns = (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+    mark->cycles = __rdtsc();
+    mark->sim_ns = profile->simulated ? m5_rpns() : 0;
+    mark->calls = profile->stats ? profile->stats->calls : 0;
+    mark->loads = profile->stats ? profile->stats->loads : 0;
+}
+
+static void add_since(const phase_profile_t *profile, phase_cost_t *cost, const phase_cost_t *start)
+{
+    phase_cost_t now;
+    take_mark(profile, &now);
+    cost->cycles += now.cycles - start->cycles;
+    cost->wall_ns += now.wall_ns - start->wall_ns;
+    cost->sim_ns += now.sim_ns - start->sim_ns;
+    // Counters reset inside the region count from zero
+    cost->calls += now.calls >= start->calls ? now.calls - start->calls : now.calls;
+    cost->loads += now.loads >= start->loads ? now.loads - start->loads : now.loads;
+}
+
+void phase_profile_init(phase_profile_t *profile, int simulated,
+                        const struct oracle_stats *stats)
+{
+    memset(profile, 0, sizeof(*profile));
+    profile->simulated = simulated;
+    profile->stats = stats;
+    profile->current = -1;
+}
+
+void phase_begin(phase_profile_t *profile, const char *name)
+{
+    if (!profile) return;
+    if (profile->current >= 0) phase_end(profile);
+
+    size_t i = 0;
+    while (i < profile->num_phases && strcmp(profile->phases[i].name, name) != 0) i++;
+    if (i == profile->num_phases) {
+        if (i == PHASE_MAX_PHASES) return;
+        profile->phases[i].name = name;
+        profile->num_phases++;
+    }
+
+    profile->current = (int)i;
+    profile->phases[i].runs++;
+    if (profile->simulated) m5_reset_stats(0, 0);
+    take_mark(profile, &profile->phase_start);
+}
+
+void phase_end(phase_profile_t *profile)
+{
+    if (!profile || profile->current < 0) return;
+    add_since(profile, &profile->phases[profile->current].cost, &profile->phase_start);
+    if (profile->simulated) m5_dump_stats(0, 0);
+    profile->current = -1;
+}
+
+void phase_rounds_reset(phase_profile_t *profile)
+{
+    if (!profile) return;
+    profile->num_rounds = 0;
+    profile->dropped_rounds = 0;
+}
+
+void phase_round_begin(phase_profile_t *profile, size_t size)
+{
+    if (!profile) return;
+    profile->round_size = size;
+    take_mark(profile, &profile->round_start);
+}
+
+void phase_round_end(phase_profile_t *profile, size_t size)
+{
+    if (!profile) return;
+    if (profile->num_rounds == PHASE_MAX_ROUNDS) {
+        profile->dropped_rounds++;
+        return;
+    }
+    phase_round_t *round = &profile->rounds[profile->num_rounds++];
+    memset(round, 0, sizeof(*round));
+    round->size_before = profile->round_size;
+    round->size_after = size;
+    add_since(profile, &round->cost, &profile->round_start);
+    if (profile->simulated) m5_dump_stats(0, 0);
+}
+
+void phase_profile_print(const phase_profile_t *profile)
+{
+    uint64_t total_cycles = 0, total_sim = 0;
+    for (size_t i = 0; i < profile->num_phases; i++) {
+        total_cycles += profile->phases[i].cost.cycles;
+        total_sim += profile->phases[i].cost.sim_ns;
+    }
+
+    printf("Phase profile%s:\n", profile->simulated ? " (gem5 stats dumped per phase)" : "");
+    printf("%-16s %5s %12s %6s %12s %12s %6s %8s %10s\n", "phase", "runs", "cycles", "cyc%",
+           "wall_us", "sim_us", "sim%", "calls", "loads");
+    for (size_t i = 0; i < profile->num_phases; i++) {
+        const phase_entry_t *p = &profile->phases[i];
+        printf("%-16s %5lu %12lu %6.1f %12.1f %12.1f %6.1f %8lu %10lu\n", p->name,
+               (unsigned long)p->runs, (unsigned long)p->cost.cycles,
+               total_cycles ? 100.0 * p->cost.cycles / total_cycles : 0.0,
+               p->cost.wall_ns / 1e3, p->cost.sim_ns / 1e3,
+               total_sim ? 100.0 * p->cost.sim_ns / total_sim : 0.0,
+               (unsigned long)p->cost.calls, (unsigned long)p->cost.loads);
+    }
+
+    if (profile->num_rounds == 0) return;
+    printf("Reduction rounds%s:\n", profile->dropped_rounds ? " (first ones only)" : "");
+    printf("%5s %8s %8s %12s %12s %12s %8s %10s\n", "round", "from", "to", "cycles",
+           "wall_us", "sim_us", "calls", "loads");
+    for (size_t r = 0; r < profile->num_rounds; r++) {
+        const phase_round_t *round = &profile->rounds[r];
+        printf("%5zu %8zu %8zu %12lu %12.1f %12.1f %8lu %10lu\n", r, round->size_before,
+               round->size_after, (unsigned long)round->cost.cycles, round->cost.wall_ns / 1e3,
+               round->cost.sim_ns / 1e3, (unsigned long)round->cost.calls,
+               (unsigned long)round->cost.loads);
+    }
+    if (profile->dropped_rounds)
+        printf("  %lu more rounds not recorded\n", (unsigned long)profile->dropped_rounds);
+}
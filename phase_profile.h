@@ -0,0 +1,77 @@
+#ifndef PHASE_PROFILE_H
+#define PHASE_PROFILE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "threshold_group_testing.h"
+
+#define PHASE_MAX_PHASES 16
+#define PHASE_MAX_ROUNDS 256
+
+// Cost of one region: cycles and wall time always, simulated time under gem5
+typedef struct {
+    uint64_t cycles;        // rdtsc
+    uint64_t wall_ns;       // CLOCK_MONOTONIC
+    uint64_t sim_ns;        // m5_rpns(), 0 in native runs
+    uint64_t calls;         // oracle calls counted by context->stats
+    uint64_t loads;
+} phase_cost_t;
+
+typedef struct {
+    const char *name;
+    uint64_t runs;          // times the phase was entered, the cost adds up
+    phase_cost_t cost;
+} phase_entry_t;
+
+// One round of threshold_group_reduction(): a removed group or a backtrack
+typedef struct {
+    size_t size_before;
+    size_t size_after;
+    phase_cost_t cost;
+} phase_round_t;
+
+/*
+* Per-phase cost table of a run.
+* Under gem5 (@simulated) every phase also resets the simulator statistics on
+* entry and dumps them on exit, and every reduction round dumps them once more:
+* stats.txt then holds one section per round, cumulative since the phase
+* started, and one for the whole phase. Native runs only read rdtsc and
+* clock_gettime(). Rounds are kept for the last reduction only.
+*/
+typedef struct phase_profile {
+    int simulated;
+    const struct oracle_stats *stats;
+
+    phase_entry_t phases[PHASE_MAX_PHASES];
+    size_t num_phases;
+    int current;            // index into phases[], -1 outside a phase
+    phase_cost_t phase_start;
+
+    phase_round_t rounds[PHASE_MAX_ROUNDS];
+    size_t num_rounds;
+    uint64_t dropped_rounds;
+    phase_cost_t round_start;
+    size_t round_size;
+} phase_profile_t;
+
+// @stats: oracle counters to read calls and loads from, may be NULL
+void phase_profile_init(phase_profile_t *profile, int simulated,
+                        const struct oracle_stats *stats);
+
+/*
+* Enter phase @name (a string literal), a phase entered again adds to its row
+* Entering a phase ends the current one. These and the round calls below record
+* nothing when @profile is NULL, so call sites need no check.
+*/
+void phase_begin(phase_profile_t *profile, const char *name);
+void phase_end(phase_profile_t *profile);
+
+// Called by the reducer around every round
+void phase_rounds_reset(phase_profile_t *profile);
+void phase_round_begin(phase_profile_t *profile, size_t size);
+void phase_round_end(phase_profile_t *profile, size_t size);
+
+void phase_profile_print(const phase_profile_t *profile);
+
+#endif //PHASE_PROFILE_H
@@ -0,0 +1,409 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <gem5/m5ops.h>
+
+#include "threshold_group_testing.h"
+#include "address_set_adapter.h"
+#include "cache_model.h"
+#include "cache_hierarchy.h"
+#include "timing.h"
+#include "traversal.h"
+#include "prng.h"
+
+/*
+* Replacement policy probe and traversal pattern selection.
+*
+* An eviction set for one target is reduced with a robust traversal, then the
+* pool is screened for more lines of the same set. Crafted access sequences
+* over those congruent lines, answered line by line through the hit level (or
+* the cache model), tell the policy apart:
+*   - random:  the victim of one miss changes between identical runs
+*   - PLRU:    re-touching the oldest line protects the next one as well
+*   - RRIP:    a re-touched line outlives a scan of `associativity` new lines
+*   - LRU:     none of the above
+* Every pattern of a small family is then run through the eviction oracle over
+* the congruent lines mixed with as many non-congruent ones, and over one
+* congruent line too few. The cheapest one that reaches the target eviction
+* rate on the first and stays under the false-positive bound on the second is
+* reported for --pattern; if none stays under it, the cheapest one reaching the
+* rate is reported with --vote.
+*/
+
+#define PROBE_REPEATS 8
+#define PATTERN_RETESTS 4
+
+typedef struct {
+    cache_model_t *model;      // NULL: m5_get_last_hit_level() after a real load
+    uint64_t level;            // deepest hit level counted as a hit
+} probe_t;
+
+// Access @addr, returns 1 if it hit at the probed level
+static int probe_access(const probe_t *p, uintptr_t addr)
+{
+    if (p->model) return cache_model_access(p->model, addr);
+
+    volatile uint8_t tmp = *(volatile uint8_t *)addr;
+    (void)tmp;
+    return m5_get_last_hit_level() <= p->level;
+}
+
+// Empty the probed set of @lines before a new sequence
+static void probe_reset(const probe_t *p, const uintptr_t *lines, size_t n)
+{
+    if (p->model) {
+        cache_model_flush(p->model);
+        return;
+    }
+    for (size_t i = 0; i < n; i++) _mm_clflush((const void *)lines[i]);
+    memory_fence();
+}
+
+static void probe_fill(const probe_t *p, const uintptr_t *x, size_t from, size_t to)
+{
+    for (size_t i = from; i < to; i++) probe_access(p, x[i]);
+}
+
+// Fill x0..x(a-1), insert xa: index of the first line that misses, a if none
+static size_t victim_of_one_miss(const probe_t *p, const uintptr_t *x, size_t a)
+{
+    probe_reset(p, x, 2 * a + 1);
+    probe_fill(p, x, 0, a);
+    probe_access(p, x[a]);
+    for (size_t i = 0; i < a; i++) {
+        if (!probe_access(p, x[i])) return i;
+    }
+    return a;
+}
+
+// Fill x0..x(a-1), touch x0, insert xa: 1 if x1 survived
+static int protects_neighbour(const probe_t *p, const uintptr_t *x, size_t a)
+{
+    probe_reset(p, x, 2 * a + 1);
+    probe_fill(p, x, 0, a);
+    probe_access(p, x[0]);
+    probe_access(p, x[a]);
+    return probe_access(p, x[1]);
+}
+
+// Fill x0..x(a-1), touch x0, scan xa..x(2a-1): 1 if x0 survived
+static int scan_resistant(const probe_t *p, const uintptr_t *x, size_t a)
+{
+    probe_reset(p, x, 2 * a + 1);
+    probe_fill(p, x, 0, a);
+    probe_access(p, x[0]);
+    probe_fill(p, x, a, 2 * a);
+    return probe_access(p, x[0]);
+}
+
+static const char *identify_policy(const probe_t *p, const uintptr_t *x, size_t a)
+{
+    size_t first = victim_of_one_miss(p, x, a);
+    int varies = 0, protects = 0, resists = 0;
+
+    for (int r = 0; r < PROBE_REPEATS; r++) {
+        varies += (victim_of_one_miss(p, x, a) != first);
+        protects += protects_neighbour(p, x, a);
+        resists += scan_resistant(p, x, a);
+    }
+    printf("  victim after one miss: x%zu, changed in %d/%d runs\n", first, varies, PROBE_REPEATS);
+    printf("  x1 kept after touching x0: %d/%d\n", protects, PROBE_REPEATS);
+    printf("  x0 kept through a scan of %zu lines: %d/%d\n", a, resists, PROBE_REPEATS);
+
+    if (varies > 0) return "random";
+    if (2 * protects > PROBE_REPEATS) return "plru";
+    if (2 * resists > PROBE_REPEATS) return "rrip";
+    return "lru";
+}
+
+/*
+* Lines congruent with the target: the reduced set itself, then every pool line it evicts
+* Returns how many were written to @x, the target first
+*/
+static size_t collect_congruent(const address_set_t *pool, const address_set_t *found,
+                                uintptr_t target, batch_eviction_test_func_t batch_func,
+                                const test_context_t *context, size_t a,
+                                uintptr_t *x, size_t max_x)
+{
+    size_t n = 0, batch = a < MAX_BATCH_TARGETS ? a : MAX_BATCH_TARGETS;
+    void *targets[MAX_BATCH_TARGETS];
+
+    x[n++] = target;
+    for (size_t i = 0; i < found->size; i++) x[n++] = found->addresses[i];
+
+    for (size_t i = 0; i < pool->size && n < max_x; i += batch) {
+        size_t k = 0;
+        for (size_t j = i; j < i + batch && j < pool->size; j++) {
+            int taken = 0;
+            for (size_t f = 0; f < found->size && !taken; f++)
+                taken = (found->addresses[f] == pool->addresses[j]);
+            if (!taken) targets[k++] = (void *)pool->addresses[j];
+        }
+
+        // Twice, a line is only congruent if both traversals evicted it
+        uint64_t evicted = batch_func(found, targets, k, context) &
+                           batch_func(found, targets, k, context);
+        for (size_t t = 0; t < k; t++) {
+            if ((evicted >> t & 1) && n < max_x) x[n++] = (uintptr_t)targets[t];
+        }
+    }
+    return n;
+}
+
+/*
+* Eviction rate of @pattern over @trials oracle calls on @lines
+* Every PATTERN_RETESTS calls the order is shuffled and the set emptied, then a
+* random number of spare congruent lines x(a+1).. is loaded so that the target
+* lands in any way. The calls in between re-test the same order like reducers
+* do: some policies settle into a state where the traversal never evicts.
+* With @scratch, each call leaves out another congruent line x(1 + t % a), the
+* way consecutive group removals hand the oracle sets that miss different
+* lines: the line the previous call skipped is now a miss, which is what makes
+* a short set evict on RRIP.
+*/
+static double pattern_rate(const traversal_pattern_t *pattern, uintptr_t *lines, size_t n,
+                           uintptr_t *scratch, const probe_t *probe, const uintptr_t *x,
+                           size_t a, eviction_test_func_t oracle, test_context_t *context,
+                           size_t trials, prng_t *rng)
+{
+    size_t evicted = 0;
+    context->pattern = pattern;
+
+    for (size_t t = 0; t < trials; t++) {
+        if (t % PATTERN_RETESTS == 0) {
+            for (size_t i = n - 1; i > 0; i--) {
+                size_t j = prng_below(rng, i + 1);
+                uintptr_t tmp = lines[i];
+                lines[i] = lines[j];
+                lines[j] = tmp;
+            }
+            probe_reset(probe, x, 2 * a + 1);
+            probe_fill(probe, x, a + 1, a + 1 + prng_below(rng, a));
+        }
+        address_set_t set = address_set_view(lines, n);
+        if (scratch) {
+            size_t m = 0;
+            for (size_t i = 0; i < n; i++) {
+                if (lines[i] != x[1 + t % a]) scratch[m++] = lines[i];
+            }
+            set = address_set_view(scratch, m);
+        }
+        evicted += oracle(&set, context) ? 1 : 0;
+    }
+    return (double)evicted / trials;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned seed = 12345;
+    const char *oracle_name = "m5";
+    replacement_policy_t policy = REPL_LRU;
+    cache_hierarchy_t hier = cache_hierarchy_default();
+    int level = 2;
+    size_t trials = 200;
+    double target_rate = 0.95;
+    double false_rate = 0.05;
+    int tries = 5;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (unsigned)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--oracle") == 0 && i + 1 < argc) {
+            oracle_name = argv[++i];
+            if (strcmp(oracle_name, "m5") != 0 && strcmp(oracle_name, "model") != 0) {
+                fprintf(stderr, "Unknown oracle: %s\n", oracle_name);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--policy") == 0 && i + 1 < argc) {
+            if (!parse_replacement_policy(argv[++i], &policy)) {
+                fprintf(stderr, "Unknown replacement policy: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--hierarchy") == 0 && i + 1 < argc) {
+            const char *spec = argv[++i];
+            int ok = strcmp(spec, "sysfs") == 0 ? cache_hierarchy_from_sysfs(&hier)
+                                                : parse_cache_hierarchy(spec, &hier);
+            if (!ok) {
+                fprintf(stderr, "Bad cache hierarchy: %s\n", spec);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--level") == 0 && i + 1 < argc) {
+            level = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--trials") == 0 && i + 1 < argc) {
+            trials = (size_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+            target_rate = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--false-rate") == 0 && i + 1 < argc) {
+            false_rate = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--tries") == 0 && i + 1 < argc) {
+            tries = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--help") == 0) {
+            printf("Usage: %s [--seed <S>] [--oracle m5|model] [--policy lru|plru|random|rrip]"
+                   " [--hierarchy <spec>|sysfs] [--level <N>] [--trials <N>] [--rate <R>]"
+                   " [--false-rate <F>] [--tries <N>]\n", argv[0]);
+            printf("  --oracle model  probe the software cache model (--policy selects its policy)\n");
+            printf("  --trials N      oracle calls per traversal pattern (default 200)\n");
+            printf("  --rate R        eviction rate the selected pattern must reach (default 0.95)\n");
+            printf("  --false-rate F  eviction rate it may show with a - 1 congruent lines\n");
+            printf("                  (default 0.05)\n");
+            return 0;
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (trials == 0) trials = 1;
+
+    srand(seed);
+    prng_t rng;
+    prng_seed(&rng, seed);
+    reduction_verbose = 0;
+
+    if (level < 1 || (size_t)level > hier.num_levels) {
+        fprintf(stderr, "Level %d is not in the %zu-level hierarchy\n", level, hier.num_levels);
+        return 1;
+    }
+    cache_config_t cfg = cache_level_config(&hier, level, 4096);
+    size_t a = cfg.associativity;
+
+    uint8_t *target = aligned_alloc(cfg.cache_line_size, cfg.cache_line_size);
+    uintptr_t *x = malloc((2 * a + 1) * sizeof(uintptr_t));
+    uintptr_t *lines = malloc(5 * a * sizeof(uintptr_t));
+    if (!target || !x || !lines) {
+        perror("alloc");
+        return 1;
+    }
+    memset(target, 0xAB, cfg.cache_line_size);
+
+    test_context_t ctx = {0};
+    ctx.target_address = target;
+    ctx.target_level = level;
+    ctx.traversal = TRAVERSE_ARRAY;
+
+    probe_t probe = { NULL, (uint64_t)level };
+    eviction_test_func_t oracle;
+    batch_eviction_test_func_t batch_oracle;
+    if (strcmp(oracle_name, "model") == 0) {
+        probe.model = cache_model_create(&cfg, policy, seed);
+        if (!probe.model) {
+            fprintf(stderr, "Cache model does not support this geometry\n");
+            return 1;
+        }
+        ctx.oracle_state = probe.model;
+        oracle = create_cache_model_tester();
+        batch_oracle = create_cache_model_batch_tester();
+    } else {
+        oracle = create_eviction_tester();
+        batch_oracle = create_batch_eviction_tester();
+    }
+
+    // Setup runs with a traversal every policy of the model gives in to
+    traversal_pattern_t robust = { 4, 0, TRAVERSE_ZIGZAG };
+    ctx.pattern = &robust;
+
+    // Page-stride candidates share the target's set one time in page colors,
+    // 64a of them hold about 2a + 1 congruent lines for up to 32 colors
+    size_t nb_candidate = 64 * a;
+    address_set_t pool = generate_candidate_set_r(target, nb_candidate, &cfg, &rng);
+    size_t n_x = 0;
+    int found_set = 0;
+
+    for (int t = 0; t < tries && n_x < 2 * a + 1; t++) {
+        if (t > 0) grow_candidate_set(&pool, target, pool.size, &cfg, &rng);
+        if (!oracle(&pool, &ctx)) continue;
+
+        address_set_t found = threshold_group_reduction(&pool, &cfg, oracle, &ctx);
+        if (found.size == a && oracle(&found, &ctx)) {
+            found_set = 1;
+            n_x = collect_congruent(&pool, &found, (uintptr_t)target, batch_oracle, &ctx, a,
+                                    x, 2 * a + 1);
+        }
+        free_address_set(&found);
+        printf("Pool of %zu: %s, %zu congruent lines\n", pool.size,
+               found_set ? "eviction set found" : "no eviction set", n_x);
+    }
+    if (n_x < 2 * a + 1) {
+        fprintf(stderr, "Need %zu congruent lines, found %zu\n", 2 * a + 1, n_x);
+        return 1;
+    }
+
+    printf("Replacement policy of L%d (%zu ways):\n", level, a);
+    const char *policy_name = identify_policy(&probe, x, a);
+    printf("Identified policy: %s\n", policy_name);
+
+    // Pattern family: repeats x windows x directions, rated on the minimal set
+    // alone (what the final check sees), mixed with as many lines of the next
+    // set (what the reducer sees on the way down), and with one congruent line
+    // missing from the mixed set (a group the reducer must not remove)
+    uintptr_t *minimal_set = &lines[2 * a];
+    uintptr_t *short_set = &lines[3 * a];
+    for (size_t i = 0; i < a; i++) {
+        lines[i] = minimal_set[i] = x[1 + i];
+        lines[a + i] = x[1 + i] + cfg.cache_line_size;
+    }
+    size_t n_lines = 2 * a;
+
+    unsigned windows[] = { 0, (unsigned)(a / 2 > 2 ? a / 2 : 2), 2 };
+    traversal_pattern_t best = { 0, 0, TRAVERSE_FORWARD };
+    uint64_t best_loads = UINT64_MAX;
+    double best_rate = 0;
+    int best_clean = 0;  // best also stays under false_rate on a - 1 lines
+
+    printf("%-12s %8s %8s %8s %8s\n", "pattern", "loads", "minimal", "mixed", "a-1");
+    for (unsigned r = 1; r <= 4; r++) {
+        for (size_t w = 0; w < sizeof(windows) / sizeof(windows[0]); w++) {
+            for (int d = TRAVERSE_FORWARD; d <= TRAVERSE_ZIGZAG; d++) {
+                traversal_pattern_t p = { r, windows[w], (traversal_dir_t)d };
+                if (r == 1 && d == TRAVERSE_ZIGZAG) continue;  // same as fwd
+
+                double minimal = pattern_rate(&p, minimal_set, a, NULL, &probe, x, a,
+                                              oracle, &ctx, trials, &rng);
+                double mixed = pattern_rate(&p, lines, n_lines, NULL, &probe, x, a,
+                                            oracle, &ctx, trials, &rng);
+                double wrong = pattern_rate(&p, lines, n_lines, short_set, &probe, x, a,
+                                            oracle, &ctx, trials, &rng);
+                double rate = minimal < mixed ? minimal : mixed;
+                uint64_t loads = traversal_pattern_loads(&p, n_lines, 0);
+                char name[32];
+                format_traversal_pattern(&p, name, sizeof(name));
+                printf("%-12s %8lu %8.3f %8.3f %8.3f\n", name, (unsigned long)loads,
+                       minimal, mixed, wrong);
+
+                int clean = wrong <= false_rate;
+                if (rate >= target_rate &&
+                    (clean > best_clean || (clean == best_clean &&
+                     (loads < best_loads || (loads == best_loads && rate > best_rate))))) {
+                    best = p;
+                    best_loads = loads;
+                    best_rate = rate;
+                    best_clean = clean;
+                }
+            }
+        }
+    }
+
+    if (best_loads == UINT64_MAX) {
+        printf("No pattern reaches an eviction rate of %.2f, use --vote\n", target_rate);
+    } else {
+        // A pattern that evicts without a congruent line makes the reducer drop
+        // it: those need the voting oracle to re-test positives
+        char name[32];
+        format_traversal_pattern(&best, name, sizeof(name));
+        if (best_clean)
+            printf("Cheapest pattern at rate >= %.2f, a - 1 rate <= %.2f: --pattern %s"
+                   " (%lu loads per %zu lines, rate %.3f)\n", target_rate, false_rate, name,
+                   (unsigned long)best_loads, n_lines, best_rate);
+        else
+            printf("No pattern stays at a - 1 rate <= %.2f, cheapest at rate >= %.2f:"
+                   " --pattern %s --vote (%lu loads per %zu lines, rate %.3f)\n", false_rate,
+                   target_rate, name, (unsigned long)best_loads, n_lines, best_rate);
+    }
+
+    free_address_set(&pool);
+    cache_model_destroy(probe.model);
+    free(lines);
+    free(x);
+    free(target);
+    return 0;
+}
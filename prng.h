@@ -0,0 +1,37 @@
+#ifndef PRNG_H
+#define PRNG_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+* Reentrant xorshift64* generator, one state per thread in place of rand()/srand()
+*/
+typedef struct {
+    uint64_t state;
+} prng_t;
+
+static inline void prng_seed(prng_t *rng, uint64_t seed) {
+    // splitmix64 step so that small consecutive seeds give unrelated streams
+    uint64_t z = seed + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    rng->state = z ? z : 1;
+}
+
+static inline uint64_t prng_next(prng_t *rng) {
+    uint64_t x = rng->state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    rng->state = x;
+    return x * 0x2545F4914F6CDD1Dull;
+}
+
+// Uniform in [0, bound), bound > 0
+static inline size_t prng_below(prng_t *rng, size_t bound) {
+    return (size_t)(prng_next(rng) % bound);
+}
+
+#endif //PRNG_H
@@ -0,0 +1,298 @@
+#include "slice_hash.h"
+#include "pagemap.h"
+#include "address_set_adapter.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int parse_slice_hash(const char *spec, slice_hash_t *out)
+{
+    slice_hash_t hash;
+    memset(&hash, 0, sizeof(hash));
+
+    char *copy = strdup(spec);
+    int ok = 1;
+    for (char *tok = strtok(copy, ","); tok; tok = strtok(NULL, ",")) {
+        char *end;
+        uint64_t mask = strtoull(tok, &end, 16);
+        if (*end != '\0' || mask == 0 || hash.num_bits == MAX_SLICE_BITS) {
+            ok = 0;
+            break;
+        }
+        hash.masks[hash.num_bits++] = mask;
+    }
+    free(copy);
+
+    if (!ok || hash.num_bits == 0) return 0;
+    *out = hash;
+    return 1;
+}
+
+void print_slice_hash(const slice_hash_t *hash)
+{
+    printf("Slice hash (%zu bit%s, %zu slices):\n", hash->num_bits,
+           hash->num_bits == 1 ? "" : "s", (size_t)1 << hash->num_bits);
+    for (size_t b = 0; b < hash->num_bits; b++)
+        printf("  o%zu = parity(pa & 0x%lx)\n", b, (unsigned long)hash->masks[b]);
+}
+
+/*
+* Address bits the hash is computed on, and which of them are trustworthy
+* Returns 0 when @bits cannot be provided here
+*/
+static int hash_input(const uintptr_t *addresses, size_t n, slice_bits_t bits,
+                      uintptr_t *out, uint64_t *known_mask)
+{
+    switch (bits) {
+    case SLICE_BITS_PAGEMAP:
+        if (virt_to_phys_bulk(addresses, n, out) < 0) return 0;
+        *known_mask = ~0ull;
+        return 1;
+    case SLICE_BITS_HUGEPAGE:
+        for (size_t i = 0; i < n; i++) out[i] = addresses[i] & (HUGE_PAGE_SIZE - 1);
+        *known_mask = HUGE_PAGE_SIZE - 1;
+        return 1;
+    case SLICE_BITS_VIRTUAL:
+        memcpy(out, addresses, n * sizeof(uintptr_t));
+        *known_mask = ~0ull;
+        return 1;
+    }
+    return 0;
+}
+
+// ---- GF(2) elimination over 64-bit rows ----
+
+// Insert @row into the basis indexed by pivot bit, returns 1 if it was independent
+static int basis_insert(uint64_t basis[64], uint64_t row)
+{
+    for (int bit = 63; bit >= 0 && row; bit--) {
+        if (!(row >> bit & 1)) continue;
+        if (!basis[bit]) {
+            basis[bit] = row;
+            return 1;
+        }
+        row ^= basis[bit];
+    }
+    return 0;
+}
+
+size_t solve_slice_hash(const uintptr_t *phys, const int *group, size_t n,
+                        uint64_t known_mask, slice_hash_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    if (n < 2) return 0;
+
+    // First address of every group is its representative
+    int max_group = -1;
+    for (size_t i = 0; i < n; i++)
+        if (group[i] > max_group) max_group = group[i];
+    if (max_group < 1) return 0;
+
+    size_t num_groups = (size_t)max_group + 1;
+    uintptr_t *rep = calloc(num_groups, sizeof(uintptr_t));
+    int *has_rep = calloc(num_groups, sizeof(int));
+    if (!rep || !has_rep) {
+        perror("calloc slice groups");
+        exit(1);
+    }
+
+    // Only bits that vary over the samples can be told apart
+    uint64_t vary = 0;
+    for (size_t i = 0; i < n; i++) vary |= (phys[i] ^ phys[0]);
+    vary &= known_mask;
+    TGT_LOG("[SliceInfer] samples vary in address bits 0x%lx, the hash is only solved there\n",
+            (unsigned long)vary);
+
+    // Row space of the same-group differences: every hash mask is orthogonal to it
+    uint64_t rows[64] = { 0 };
+    for (size_t i = 0; i < n; i++) {
+        if (group[i] < 0) continue;
+        if (!has_rep[group[i]]) {
+            rep[group[i]] = phys[i];
+            has_rep[group[i]] = 1;
+            continue;
+        }
+        basis_insert(rows, (phys[i] ^ rep[group[i]]) & vary);
+    }
+
+    // Reduced echelon form: each pivot bit appears in its own row only
+    for (int p = 0; p < 64; p++) {
+        if (!rows[p]) continue;
+        for (int q = 0; q < 64; q++) {
+            if (q != p && rows[q] && (rows[q] >> p & 1)) rows[q] ^= rows[p];
+        }
+    }
+
+    // Null space: one vector per free (non-pivot) varying bit
+    uint64_t sig_basis[64] = { 0 };
+    for (int f = 0; f < 64 && out->num_bits < MAX_SLICE_BITS; f++) {
+        if (!(vary >> f & 1) || rows[f]) continue;
+        uint64_t v = 1ull << f;
+        for (int p = 0; p < 64; p++) {
+            if (rows[p] && (rows[p] >> f & 1)) v |= 1ull << p;
+        }
+
+        // Keep it if it separates the groups in a way the kept ones do not
+        uint64_t sig = 0;
+        for (size_t g = 1; g < num_groups && g < 64; g++) {
+            if (has_rep[g]) sig |= (uint64_t)__builtin_parityll(v & (rep[g] ^ rep[0])) << g;
+        }
+        if (sig && basis_insert(sig_basis, sig))
+            out->masks[out->num_bits++] = v;
+    }
+
+    free(has_rep);
+    free(rep);
+    return out->num_bits;
+}
+
+// Drop from pool[0..*n) every address of @found
+static void remove_lines(uintptr_t *pool, size_t *n, const address_set_t *found)
+{
+    size_t out = 0;
+    for (size_t i = 0; i < *n; i++) {
+        int in_found = 0;
+        for (size_t k = 0; k < found->size && !in_found; k++)
+            in_found = (found->addresses[k] == pool[i]);
+        if (!in_found) pool[out++] = pool[i];
+    }
+    *n = out;
+}
+
+size_t infer_slice_hash(const cache_config_t *cfg, size_t slices,
+                        const address_set_t *pool, slice_bits_t bits,
+                        reduction_func_t reducer,
+                        eviction_test_func_t test_func,
+                        batch_eviction_test_func_t batch_func,
+                        test_context_t *context,
+                        slice_hash_t *out)
+{
+    size_t a = cfg->associativity;
+    size_t batch = a < MAX_BATCH_TARGETS ? a : MAX_BATCH_TARGETS;
+    size_t total = pool->size;
+
+    memset(out, 0, sizeof(*out));
+
+    uintptr_t *U = malloc(total * sizeof(uintptr_t));          // unclassified
+    uintptr_t *lines = malloc(total * sizeof(uintptr_t));      // classified, with their group
+    int *group = malloc(total * sizeof(int));
+    uintptr_t *input = malloc(total * sizeof(uintptr_t));
+    if (!U || !lines || !group || !input) {
+        perror("malloc slice inference");
+        exit(1);
+    }
+    memcpy(U, pool->addresses, total * sizeof(uintptr_t));
+    size_t n = total, classified = 0;
+    int groups = 0;
+
+    while ((size_t)groups < slices && n > a + 1) {
+        uintptr_t target = U[--n];
+        context->target_address = (void *)target;
+
+        address_set_t rest = address_set_view(U, n);
+        if (!test_func(&rest, context)) {
+            TGT_LOG("[SliceInfer] pool of %zu does not evict 0x%lx, skipping it\n", n, target);
+            continue;
+        }
+
+        address_set_t found = reducer(&rest, cfg, test_func, context);
+        if (found.size != a || !test_func(&found, context)) {
+            TGT_LOG("[SliceInfer] reduction for 0x%lx failed (size %zu)\n", target, found.size);
+            free_address_set(&found);
+            continue;
+        }
+
+        int g = groups++;
+        lines[classified] = target;
+        group[classified++] = g;
+        for (size_t i = 0; i < found.size; i++) {
+            lines[classified] = found.addresses[i];
+            group[classified++] = g;
+        }
+        remove_lines(U, &n, &found);
+
+        // Whatever the new set evicts shares its slice
+        void *targets[MAX_BATCH_TARGETS];
+        size_t kept = 0;
+        for (size_t i = 0; i < n; i += batch) {
+            size_t k = (n - i < batch) ? n - i : batch;
+            for (size_t t = 0; t < k; t++) targets[t] = (void *)U[i + t];
+            uint64_t evicted = batch_func(&found, targets, k, context);
+            for (size_t t = 0; t < k; t++) {
+                if (evicted & (1ull << t)) {
+                    lines[classified] = (uintptr_t)targets[t];
+                    group[classified++] = g;
+                } else {
+                    U[kept++] = (uintptr_t)targets[t];
+                }
+            }
+        }
+        n = kept;
+        free_address_set(&found);
+
+        TGT_LOG("[SliceInfer] slice group %d: %zu lines classified, %zu left\n",
+                g, classified, n);
+    }
+
+    uint64_t known_mask;
+    size_t found_bits = 0;
+    if (groups < 2) {
+        TGT_LOG("[SliceInfer] only %d slice group%s found\n", groups, groups == 1 ? "" : "s");
+    } else if (!hash_input(lines, classified, bits, input, &known_mask)) {
+        TGT_LOG("[SliceInfer] physical address bits unavailable\n");
+    } else {
+        // Line offset bits never take part in the hash
+        known_mask &= ~(uint64_t)(cfg->cache_line_size - 1);
+        found_bits = solve_slice_hash(input, group, classified, known_mask, out);
+    }
+
+    free(input);
+    free(group);
+    free(lines);
+    free(U);
+    return found_bits;
+}
+
+int slice_filter_candidates(address_set_t *set, void *target_addr,
+                            const slice_hash_t *hash, slice_bits_t bits)
+{
+    uintptr_t target = (uintptr_t)target_addr, target_in;
+    uint64_t known_mask;
+
+    // Fault the target in first, a page that was never touched has no frame
+    volatile uint8_t tmp = *(volatile uint8_t *)target_addr;
+    (void)tmp;
+
+    uintptr_t *input = malloc(set->size * sizeof(uintptr_t));
+    if (!input) {
+        perror("malloc slice filter");
+        exit(1);
+    }
+    if (!hash_input(&target, 1, bits, &target_in, &known_mask) ||
+        !hash_input(set->addresses, set->size, bits, input, &known_mask)) {
+        TGT_LOG("[SliceFilter] address bits unavailable, keeping all %zu candidates\n", set->size);
+        free(input);
+        return 0;
+    }
+    for (size_t b = 0; b < hash->num_bits; b++) {
+        if (hash->masks[b] & ~known_mask) {
+            TGT_LOG("[SliceFilter] hash reads bits that are not known, keeping all %zu candidates\n",
+                    set->size);
+            free(input);
+            return 0;
+        }
+    }
+
+    size_t target_slice = slice_of(hash, target_in);
+    size_t before = set->size, kept = 0;
+    for (size_t i = 0; i < before; i++) {
+        if (input[i] && slice_of(hash, input[i]) == target_slice)
+            set->addresses[kept++] = set->addresses[i];
+    }
+    set->size = kept;
+    free(input);
+
+    TGT_LOG("[SliceFilter] kept %zu of %zu candidates (slice %zu)\n", kept, before, target_slice);
+    return 1;
+}
@@ -0,0 +1,73 @@
+#ifndef SLICE_HASH_H
+#define SLICE_HASH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "threshold_group_testing.h"
+
+#define MAX_SLICE_BITS 6
+
+/*
+* Linear (XOR) slice hash of a sliced cache: bit b of the slice number is the
+* parity of the physical address bits selected by masks[b].
+*/
+typedef struct {
+    size_t num_bits;                    // log2(slices)
+    uint64_t masks[MAX_SLICE_BITS];
+} slice_hash_t;
+
+// Where the address bits the hash reads come from
+typedef enum {
+    SLICE_BITS_PAGEMAP = 0,     // physical addresses from /proc/self/pagemap
+    SLICE_BITS_HUGEPAGE,        // virtual bits inside a 2 MiB page, the only physical ones known
+    SLICE_BITS_VIRTUAL          // virtual addresses are the physical ones (software cache model)
+} slice_bits_t;
+
+static inline size_t slice_of(const slice_hash_t *hash, uintptr_t phys) {
+    size_t slice = 0;
+    for (size_t b = 0; b < hash->num_bits; b++)
+        slice |= (size_t)__builtin_parityll(phys & hash->masks[b]) << b;
+    return slice;
+}
+
+// Parse comma-separated hex masks, returns 1 on success
+int parse_slice_hash(const char *spec, slice_hash_t *out);
+
+void print_slice_hash(const slice_hash_t *hash);
+
+/*
+* Solve for a hash that is constant inside every group and tells the groups apart
+* @phys: Addresses as seen by the hash, only the bits of @known_mask are trusted
+* @group: Group (slice) label of each address, labels are arbitrary
+* Returns the number of hash bits found (0 if the samples do not determine any)
+*/
+size_t solve_slice_hash(const uintptr_t *phys, const int *group, size_t n,
+                        uint64_t known_mask, slice_hash_t *out);
+
+/*
+* Slice inference: group the lines of @pool by the eviction sets they belong to
+* and solve for the hash that explains the grouping
+* @cfg: Geometry of one slice of the sliced level (see cache_level_config())
+* @pool: Candidates of one physical set index (pagemap-filtered or huge-page pool),
+*        at least slices * associativity of them per slice
+* @context: target_address is overwritten for every pool line, the rest is used as is
+* Returns the number of hash bits found
+*/
+size_t infer_slice_hash(const cache_config_t *cfg, size_t slices,
+                        const address_set_t *pool, slice_bits_t bits,
+                        reduction_func_t reducer,
+                        eviction_test_func_t test_func,
+                        batch_eviction_test_func_t batch_func,
+                        test_context_t *context,
+                        slice_hash_t *out);
+
+/*
+* Keep only the candidates that @hash puts into the target's slice
+* Returns 1 when the set was filtered, 0 when the address bits the hash needs
+* are not available and @set was left untouched
+*/
+int slice_filter_candidates(address_set_t *set, void *target_addr,
+                            const slice_hash_t *hash, slice_bits_t bits);
+
+#endif //SLICE_HASH_H
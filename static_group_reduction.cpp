@@ -0,0 +1,61 @@
+#include "static_group_reduction.hpp"
+
+extern "C" {
+#include "static_group_reduction.h"
+#include "address_set_adapter.h"
+}
+
+// Associativity compiled in, the level the tools target by default
+#ifndef STATIC_REDUCTION_WAYS
+#define STATIC_REDUCTION_WAYS 8
+#endif
+
+// 0 for binaries that only ever run the m5 or timing oracle (m5_evic under gem5)
+#ifndef STATIC_REDUCTION_MODEL_ORACLE
+#define STATIC_REDUCTION_MODEL_ORACLE 1
+#endif
+
+using namespace evic;
+
+// Run-time associativity, any oracle and traversal: the C reducer
+address_set_t threshold_group_reduction(const address_set_t *candidate_set,
+                                        const cache_config_t *config,
+                                        eviction_test_func_t test_func,
+                                        const test_context_t *context)
+{
+    return reduction<0>(candidate_set, config->associativity,
+                        FuncOracle{ test_func, context }, context);
+}
+
+// The oracle behind @test_func, inlined when it is the cache model's
+template <size_t A>
+static address_set_t dispatch_oracle(const address_set_t *candidate_set,
+                                     eviction_test_func_t test_func,
+                                     const test_context_t *context)
+{
+#if STATIC_REDUCTION_MODEL_ORACLE
+    eviction_test_func_t inner = oracle_stats_unwrap(test_func, context);
+    if (inner == create_cache_model_tester() && context->oracle_state) {
+        cache_model_t *model = (cache_model_t *)context->oracle_state;
+        uintptr_t target = (uintptr_t)context->target_address;
+        oracle_stats_t *stats = inner != test_func ? context->stats : NULL;
+        if (context->pattern)
+            return reduction<A>(candidate_set, A,
+                                ModelOracle<PatternPass>{ model, target, context, stats }, context);
+        return reduction<A>(candidate_set, A,
+                            ModelOracle<ForwardPass>{ model, target, context, stats }, context);
+    }
+#endif
+    return reduction<A>(candidate_set, A, FuncOracle{ test_func, context }, context);
+}
+
+address_set_t static_group_reduction(const address_set_t *candidate_set,
+                                     const cache_config_t *config,
+                                     eviction_test_func_t test_func,
+                                     const test_context_t *context)
+{
+    if (context->traversal == TRAVERSE_ARRAY && context->target_address &&
+        config->associativity == STATIC_REDUCTION_WAYS)
+        return dispatch_oracle<STATIC_REDUCTION_WAYS>(candidate_set, test_func, context);
+    return threshold_group_reduction(candidate_set, config, test_func, context);
+}
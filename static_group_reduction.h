@@ -0,0 +1,27 @@
+#ifndef STATIC_GROUP_REDUCTION_H
+#define STATIC_GROUP_REDUCTION_H
+
+#include "threshold_group_testing.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+* threshold_group_reduction() compiled for one associativity, STATIC_REDUCTION_WAYS
+* (STATIC_WAYS in the Makefile, 8 by default). Unless the build leaves it
+* out (m5_evic), the cache model oracle, counted or not, is inlined into the
+* reduction loop; every other oracle is still called through @test_func. Other
+* associativities and chase mode fall back to threshold_group_reduction(), so it
+* can sit behind any reduction_func_t.
+*/
+address_set_t static_group_reduction(const address_set_t *candidate_set,
+                                     const cache_config_t *config,
+                                     eviction_test_func_t test_func,
+                                     const test_context_t *context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //STATIC_GROUP_REDUCTION_H
@@ -0,0 +1,296 @@
+#ifndef STATIC_GROUP_REDUCTION_HPP
+#define STATIC_GROUP_REDUCTION_HPP
+
+/*
+* Threshold group testing, the one implementation of the reduction loop.
+* The associativity is a template parameter (0: read at run time) and the
+* oracle, its traversal and the partition are policies. threshold_group_reduction()
+* is the run-time instantiation behind a function pointer; static_group_reduction()
+* adds a compile-time one with the cache model inlined (see static_group_reduction.h).
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <x86intrin.h>
+
+extern "C" {
+#include "threshold_group_testing.h"
+#include "oracle_stats.h"
+#include "oracle_trace.h"
+#include "phase_profile.h"
+#include "cache_model.h"
+#include "traversal.h"
+#include "evlist.h"
+}
+
+namespace evic {
+
+// ---- Partition policies: bounds(n, ways, j, &start, &len) of group j out of ways + 1 ----
+
+// Contiguous groups of n / (ways + 1) lines, the first n % (ways + 1) one line longer
+struct EqualGroups {
+    // Inlined with a constant @ways the divisor is a multiply and a shift
+    static inline void bounds(size_t n, size_t ways, size_t j, size_t *start, size_t *len) {
+        size_t subset_size = n / (ways + 1);
+        size_t remainder = n % (ways + 1);
+
+        *len = subset_size + (j < remainder ? 1 : 0);
+        *start = j * subset_size + (j < remainder ? j : remainder);
+    }
+};
+
+// ---- Traversal policies: walk(lines, n, context, visit) calls visit on each line ----
+
+// One forward pass, what the oracles do without a pattern
+struct ForwardPass {
+    template <class Visit>
+    static inline void walk(const uintptr_t *lines, size_t n, const test_context_t *, Visit visit) {
+        for (size_t i = 0; i < n; i++) visit(lines[i]);
+    }
+};
+
+// context->pattern, as traverse_pattern() walks an array
+struct PatternPass {
+    template <class Visit>
+    static inline void walk(const uintptr_t *lines, size_t n, const test_context_t *context,
+                            Visit visit) {
+        const traversal_pattern_t *p = context->pattern;
+        unsigned repeat = (p && p->repeat) ? p->repeat : 1;
+        size_t window = (p && p->window && p->window < n) ? p->window : n;
+        traversal_dir_t dir = p ? p->dir : TRAVERSE_FORWARD;
+
+        for (size_t start = 0; start + window <= n && window; start++) {
+            for (unsigned r = 0; r < repeat; r++) {
+                bool backward = dir == TRAVERSE_BACKWARD || (dir == TRAVERSE_ZIGZAG && (r & 1));
+                for (size_t k = 0; k < window; k++)
+                    visit(lines[backward ? start + window - 1 - k : start + k]);
+            }
+        }
+    }
+};
+
+// ---- Oracle policies: operator()(set) answers whether @set evicts the target ----
+// chains: the oracle accepts a set->chain, so the reduction may run in chase mode
+
+// Any eviction_test_func_t, wrappers included: one indirect call per test
+struct FuncOracle {
+    static const bool chains = true;
+    eviction_test_func_t test_func;
+    const test_context_t *context;
+
+    inline int operator()(const address_set_t &set) const {
+        return test_func(&set, context);
+    }
+};
+
+/*
+* The cache model oracle inlined: same prime / traverse / reload sequence and
+* the same trace record, counted into @stats as its accounting wrapper would
+*/
+template <class Traversal>
+struct ModelOracle {
+    static const bool chains = false;
+    cache_model_t *model;
+    uintptr_t target;
+    const test_context_t *context;
+    oracle_stats_t *stats;      // NULL when the oracle was not wrapped
+
+    inline int operator()(const address_set_t &set) const {
+        cache_model_t *m = model;
+        cache_model_access(m, target);
+        Traversal::walk(set.addresses, set.size, context,
+                        [m](uintptr_t addr) { cache_model_access(m, addr); });
+
+        int evicted = !cache_model_access(m, target);
+        oracle_trace_record(context->trace, ORACLE_TRACE_SINGLE, set.size, evicted, 0, 0);
+        if (stats) oracle_stats_record(stats, &set, context, evicted);
+        return evicted;
+    }
+};
+
+static inline void swap_ranges(uintptr_t *a, uintptr_t *b, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        uintptr_t tmp = a[i];
+        a[i] = b[i];
+        b[i] = tmp;
+    }
+}
+
+/*
+* Exchange group W[start..start+len) with the tail W[n-len..n) so that S without
+* the group is the prefix W[0..n-len). Only the elements not already in the tail
+* move, so calling it twice restores the original order.
+*/
+static inline void swap_group_to_tail(uintptr_t *W, size_t n, size_t start, size_t len) {
+    if (start + len <= n - len)
+        swap_ranges(&W[start], &W[n - len], len);
+    else
+        swap_ranges(&W[start], &W[start + len], n - start - len);
+}
+
+/*
+* Reduce W[0..n) in place: S is the prefix W[0..n), the removed groups are
+* stacked right behind it, most recent first
+* @ways: associativity when A is 0, ignored otherwise
+* @group_len: room for n removed group sizes
+* Returns the size of the reduced prefix of W, the associativity only once the
+* oracle confirmed that prefix
+*/
+template <size_t A, class Oracle, class Partition = EqualGroups>
+size_t reduce(uintptr_t *W, size_t n, size_t ways, size_t *group_len, const Oracle &oracle,
+              const test_context_t *context) {
+    const size_t a = A ? A : ways;
+    const size_t MAX_BACKTRACKS = 4 * a;   // bound on re-inserted groups per reduction
+    size_t depth = 0;
+    size_t backtracks = 0;
+    int verified = 1;   // the caller found the candidate set to evict
+
+    // In chase mode S is linked once per round and each group is spliced
+    // out of the chain, the array only moves once a group is removed
+    const bool chase = Oracle::chains && context->traversal == TRAVERSE_CHASE;
+
+    phase_rounds_reset(context->profile);
+    while (n > a || !verified) {
+        // The last group went without a test: S must evict before it is minimal
+        if (n == a) {
+            TGT_LOG_STEP("Checking the %zu remaining elements: ", n);
+            phase_round_begin(context->profile, n);
+            if (chase) evlist_link(W, n);
+            address_set_t set = address_set_view(W, n);
+            if (chase) {
+                set.addresses = NULL;
+                set.chain = W[0];
+            }
+            verified = oracle(set);
+            TGT_LOG_STEP("%s\n", verified ? "evicts" : "no eviction");
+        } else {
+            TGT_LOG_STEP("Reducing from %zu to ", n);
+            phase_round_begin(context->profile, n);
+        }
+
+        // Try to find one of the a+1 groups that can be safely removed
+        int found_reducible_subset = 0;
+        size_t kept = 0;
+
+        if (chase && n > a) evlist_link(W, n);
+
+        for (size_t j = 0; j < a + 1 && n > a; j++) {
+            size_t start, len;
+            Partition::bounds(n, a, j, &start, &len);
+
+            address_set_t prefix = address_set_view(W, n - len);
+            if (chase) {
+                prefix.addresses = NULL;
+                prefix.chain = evlist_splice_out(W, n, start, len);
+            } else {
+                // Move T_j to the tail so that S without T_j is the prefix W[0..n-len)
+                swap_group_to_tail(W, n, start, len);
+            }
+
+            // At most a groups can hold a congruent address: once a groups
+            // have been kept, the last one is removable without a test.
+            // Only while S itself was confirmed by a test, otherwise a wrong
+            // guess would be followed by more guesses and never backtracked.
+            int untested = (kept == a) && verified;
+
+            // Test if S without T_j is still an eviction set
+            if (untested || oracle(prefix)) {
+                TGT_LOG_STEP("%zu elements (removed subset %zu%s)\n",
+                             n - len, j, untested ? ", untested" : "");
+
+                // T_j stays right behind the prefix, on top of the removed stack
+                if (chase) swap_group_to_tail(W, n, start, len);
+                n -= len;
+                group_len[depth++] = len;
+
+                verified = !untested;
+                found_reducible_subset = 1;
+                break;
+            }
+
+            // Not an eviction set without this subset, put it back and keep looking
+            if (chase)
+                evlist_restore(W, start);
+            else
+                swap_group_to_tail(W, n, start, len);
+            kept++;
+        }
+
+        if (n == a && verified) {
+            phase_round_end(context->profile, n);
+            break;
+        }
+
+        if (!found_reducible_subset) {
+            // Every group looks necessary: a previous answer was wrong.
+            // Undo the most recent removal and partition again one level up.
+            if (depth > 0 && backtracks < MAX_BACKTRACKS) {
+                backtracks++;
+                if (context->stats) context->stats->retries++;
+
+                n += group_len[--depth];
+                verified = 0;
+
+                TGT_LOG_STEP("no reducible subset, backtracking to %zu elements "
+                             "(%zu/%zu)\n", n, backtracks, MAX_BACKTRACKS);
+                phase_round_end(context->profile, n);
+                continue;
+            }
+
+            // Never hand back `a` lines the oracle rejected, the last S that evicted is larger
+            if (n == a && depth > 0) n += group_len[--depth];
+
+            TGT_LOG_STEP("FAILED - cannot find reducible subset\n");
+            phase_round_end(context->profile, n);
+            break;
+        }
+        phase_round_end(context->profile, n);
+    }
+    return n;
+}
+
+/*
+* Reduce a copy of @candidate_set with @oracle, A ways (or @ways when A is 0)
+* Same contract as threshold_group_reduction(): the result is a new set
+*/
+template <size_t A, class Oracle, class Partition = EqualGroups>
+address_set_t reduction(const address_set_t *candidate_set, size_t ways, const Oracle &oracle,
+                        const test_context_t *context) {
+    size_t n = candidate_set->size;
+    size_t a = A ? A : ways;
+
+    // Working copy of the candidate set, the only copy of the whole pool, and
+    // the removed group sizes in one allocation
+    void *arena = malloc(n * (sizeof(uintptr_t) + sizeof(size_t)) + 1);
+    if (!arena) {
+        perror("malloc reduction arena");
+        exit(1);
+    }
+    uintptr_t *W = (uintptr_t *)arena;
+    size_t *group_len = (size_t *)(W + n);
+    memcpy(W, candidate_set->addresses, n * sizeof(uintptr_t));
+
+    TGT_LOG("Starting threshold group reduction:\n");
+    TGT_LOG("  Initial set size: %zu\n", n);
+    TGT_LOG("  Target associativity: %zu\n", a);
+    TGT_LOG("  Target address: 0x%lx\n", (uintptr_t)context->target_address);
+
+    n = reduce<A, Oracle, Partition>(W, n, a, group_len, oracle, context);
+
+    // Result set (minimal eviction set), sized for the failure case too
+    address_set_t result = create_address_set(n > a ? n : a);
+    result.size = n;
+    memcpy(result.addresses, W, n * sizeof(uintptr_t));
+
+    if (n == a)
+        TGT_LOG("SUCCESS: Found minimal eviction set of size %zu\n", result.size);
+    else
+        TGT_LOG("FAILED: Could not reduce to minimal size. Current size: %zu\n", n);
+
+    free(arena);
+    return result;
+}
+
+} // namespace evic
+
+#endif //STATIC_GROUP_REDUCTION_HPP
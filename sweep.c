@@ -0,0 +1,127 @@
+#include "sweep.h"
+#include "binary_search_reduction.h"
+#include "static_group_reduction.h"
+
+#include <gem5/m5ops.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SWEEP_READ_CHUNK 4096
+
+int parse_sweep_run(const char *line, sweep_run_t *run)
+{
+    char *copy = strdup(line);
+    char *save = NULL;
+    int ok = 1;
+
+    for (char *word = strtok_r(copy, " \t", &save); word && ok; word = strtok_r(NULL, " \t", &save)) {
+        char *value = strchr(word, '=');
+        if (!value) {
+            ok = 0;
+            break;
+        }
+        *value++ = '\0';
+
+        if (strcmp(word, "seed") == 0) {
+            char *end;
+            run->seed = (unsigned)strtoul(value, &end, 0);
+            if (end == value || *end != '\0') ok = 0;
+        } else if (strcmp(word, "reducer") == 0) {
+            if (strcmp(value, "tgt") == 0) {
+                run->reducer_name = "tgt";
+                run->reducer = threshold_group_reduction;
+            } else if (strcmp(value, "tgt-static") == 0) {
+                run->reducer_name = "tgt-static";
+                run->reducer = static_group_reduction;
+            } else if (strcmp(value, "bs") == 0) {
+                run->reducer_name = "bs";
+                run->reducer = binary_search_reduction;
+            } else {
+                ok = 0;
+            }
+        } else if (strcmp(word, "pattern") == 0) {
+            ok = parse_traversal_pattern(value, &run->pattern);
+            run->use_pattern = 1;
+        } else if (strcmp(word, "vote") == 0) {
+            run->vote = atoi(value);
+        } else if (strcmp(word, "prefix") == 0) {
+            run->prefix = atoi(value);
+        } else if (strcmp(word, "verbose") == 0) {
+            run->verbose = atoi(value);
+        } else {
+            ok = 0;
+        }
+    }
+
+    free(copy);
+    return ok;
+}
+
+int parse_sweep_file(const char *text, const sweep_run_t *defaults,
+                     sweep_run_t *runs, size_t max)
+{
+    int n = 0;
+    const char *line = text;
+
+    while (*line && (size_t)n < max) {
+        size_t len = strcspn(line, "\n");
+        char buf[512];
+        size_t copy = len < sizeof(buf) - 1 ? len : sizeof(buf) - 1;
+        memcpy(buf, line, copy);
+        buf[copy] = '\0';
+        buf[strcspn(buf, "#\r")] = '\0';
+        line += len + (line[len] == '\n');
+
+        if (strspn(buf, " \t") == strlen(buf)) continue;
+
+        runs[n] = *defaults;
+        if (!parse_sweep_run(buf, &runs[n])) {
+            fprintf(stderr, "Bad sweep line: %s\n", buf);
+            return -1;
+        }
+        n++;
+    }
+    return n;
+}
+
+char *read_sweep_file(const char *path)
+{
+    size_t len = 0, cap = SWEEP_READ_CHUNK;
+    char *text = malloc(cap + 1);
+    if (!text) {
+        perror("malloc sweep file");
+        exit(1);
+    }
+
+    FILE *f = NULL;
+    if (path && !(f = fopen(path, "r"))) {
+        perror("fopen sweep file");
+        free(text);
+        return NULL;
+    }
+
+    for (;;) {
+        if (len == cap) {
+            cap *= 2;
+            text = realloc(text, cap + 1);
+            if (!text) {
+                perror("realloc sweep file");
+                exit(1);
+            }
+        }
+        size_t got = f ? fread(text + len, 1, cap - len, f)
+                       : (size_t)m5_read_file(text + len, cap - len, len);
+        if (got == 0) break;
+        len += got;
+    }
+    if (f) fclose(f);
+
+    text[len] = '\0';
+    if (len == 0) {
+        free(text);
+        return NULL;
+    }
+    return text;
+}
@@ -0,0 +1,48 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include "threshold_group_testing.h"
+#include "traversal.h"
+#include "voting_oracle.h"
+
+#define SWEEP_MAX_RUNS 256
+
+/*
+* One reduction of a checkpoint sweep.
+* Parameter files hold one run per line as "key=value" words, keys missing
+* from a line keep the defaults: seed, reducer (tgt|tgt-static|bs), pattern (r:w:dir),
+* vote (0|1), prefix (0|1) and verbose (0-3). Empty lines and '#' comments
+* are skipped.
+*/
+typedef struct {
+    unsigned seed;             // shuffles the pool before the reduction
+    const char *reducer_name;
+    reduction_func_t reducer;
+    traversal_pattern_t pattern;
+    int use_pattern;
+    int vote;
+    const voting_oracle_t *voting; // parameters of vote=1 runs, from the command line
+    int prefix;                // shortest evicting prefix first (prefix_reduction())
+    int verbose;
+} sweep_run_t;
+
+// Parse the words of @line onto @run, returns 0 on an unknown key or bad value
+int parse_sweep_run(const char *line, sweep_run_t *run);
+
+/*
+* Split @text into runs that start from @defaults
+* Returns the number of runs written to runs[0..max), -1 at the first bad line
+*/
+int parse_sweep_file(const char *text, const sweep_run_t *defaults,
+                     sweep_run_t *runs, size_t max);
+
+/*
+* Contents of the parameter file, NUL-terminated, the caller frees it
+* @path: Read with stdio when set (native runs, and gem5 SE where the host file
+*        is opened directly), otherwise through m5_read_file() from the file gem5
+*        was given as readfile (FS mode)
+* Returns NULL when the file is missing or empty
+*/
+char *read_sweep_file(const char *path);
+
+#endif //SWEEP_H
@@ -3,12 +3,25 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdio.h>
+
+// One allocation of candidate pool memory, a grown pool chains several
+typedef struct pool_chunk {
+    struct pool_chunk *next;
+    void *base;
+    size_t bytes;
+    int mapped;     // base comes from mmap() and is released with munmap(), else free()
+} pool_chunk_t;
 
 typedef struct {
     uintptr_t *addresses;
-    void *backing; // this points to the allocated memory pool
+    void *backing; // this points to the allocated memory pool (first chunk when chunked)
+    pool_chunk_t *chunks; // Every pool allocation owned by the set, NULL when backing is a single malloc
     size_t size;
     size_t capacity;
+    // First line of an intrusive next-pointer chain (see evlist.h), 0 if unlinked.
+    // When set, oracles traverse the chain and addresses may be NULL.
+    uintptr_t chain;
 } address_set_t;
 
 
@@ -19,15 +32,46 @@ typedef struct {
     size_t l2_size;      
 } cache_config_t;
 
+struct oracle_stats;
+struct voting_oracle;
+struct traversal_pattern;
+struct oracle_trace;
+struct phase_profile;
+
+typedef enum {
+    TRAVERSE_ARRAY = 0,    // oracles walk set->addresses[]
+    TRAVERSE_CHASE         // reducers link the lines and oracles chase set->chain
+} traversal_mode_t;
+
 typedef struct {
     void *target_address;
     void *calibration_data;    // Timing thresholds (cache_timing_t*)
     int skip_calibration;
     const char *calibration_file;
+    void *oracle_state;        // Oracle backend instance (cache_model_t* for the model oracle)
+    struct oracle_stats *stats; // Optional call accounting (see oracle_stats.h), may be NULL
+    traversal_mode_t traversal;
+    struct voting_oracle *vote; // Sequential voting parameters (see voting_oracle.h), may be NULL
+    int target_level;          // Cache level the set must evict the target from (1 = L1), 0 for L2
+    const struct traversal_pattern *pattern; // Oracle access pattern (see traversal.h), NULL for one pass
+    struct oracle_trace *trace; // Ring of oracle call records (see oracle_trace.h), may be NULL
+    struct phase_profile *profile; // Per-round costs of the reduction (see phase_profile.h), may be NULL
 } test_context_t;
 
 
 address_set_t create_address_set(size_t capacity);
+
+// Non-owning view of addresses[0..len), never pass it to free_address_set()
+static inline address_set_t address_set_view(uintptr_t *addresses, size_t len) {
+    address_set_t view;
+    view.addresses = addresses;
+    view.backing = NULL;
+    view.chunks = NULL;
+    view.size = len;
+    view.capacity = len;
+    view.chain = 0;
+    return view;
+}
 void free_address_set(address_set_t *set);
 void print_address_set(const address_set_t *set, const char *name);
 
@@ -36,7 +80,36 @@ void print_address_set(const address_set_t *set, const char *name);
 typedef int (*eviction_test_func_t)(const address_set_t *set, 
                                    const test_context_t *context);
 
+#define MAX_BATCH_TARGETS 64
+
+/*
+* Batched oracle: prime every target, traverse @set once, then reload each target.
+* Bit i of the result is set when targets[i] was evicted (num_targets <= MAX_BATCH_TARGETS).
+* context->target_address is ignored. Targets must not conflict among themselves:
+* at most `associativity` of them may share a cache set.
+*/
+typedef uint64_t (*batch_eviction_test_func_t)(const address_set_t *set,
+                                               void *const *targets,
+                                               size_t num_targets,
+                                               const test_context_t *context);
+
+
+/*
+* Progress messages of the reduction and candidate generation
+* 0: none, 1: summaries (default), 2: every reduction step as well
+*/
+extern int reduction_verbose;
+
+#define TGT_LOG(...) do { if (reduction_verbose) printf(__VA_ARGS__); } while (0)
+#define TGT_LOG_STEP(...) do { if (reduction_verbose >= 2) printf(__VA_ARGS__); } while (0)
+
+// Signature shared by every reducer: candidate pool in, (minimal) eviction set out
+typedef address_set_t (*reduction_func_t)(const address_set_t *candidate_set,
+                                          const cache_config_t *config,
+                                          eviction_test_func_t test_func,
+                                          const test_context_t *context);
 
+// Threshold group testing, the run-time instantiation of the loop in static_group_reduction.hpp
 address_set_t threshold_group_reduction(const address_set_t *candidate_set,
                                        const cache_config_t *config,
                                        eviction_test_func_t test_func,
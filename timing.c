@@ -1,5 +1,14 @@
 #include "timing.h"
+#include "evlist.h"
+
+#include <gem5/m5ops.h>
+
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TIMING_CALIBRATION_SAMPLES 1000
+#define TIMING_CHECK_SAMPLES       64
 
 uint64_t measure_access_time(volatile void *address) {
     volatile uint64_t *addr = (volatile uint64_t*)address;
@@ -8,11 +17,11 @@ uint64_t measure_access_time(volatile void *address) {
     memory_fence();
     compiler_barrier();
     
-    uint64_t start = rdtsc();
+    uint64_t start = timer_start();
     // Force the compiler to actually perform the memory access
     volatile uint64_t value = *addr;
     (void)value; // Prevent unused variable warning
-    uint64_t end = rdtsc();
+    uint64_t end = timer_stop();
     
     memory_fence();
     compiler_barrier();
@@ -27,7 +36,7 @@ uint64_t measure_access_time_with_level(volatile void *address, uint64_t *level_
     memory_fence();
     compiler_barrier();
 
-    uint64_t start = rdtsc();
+    uint64_t start = timer_start();
 
     
     volatile uint64_t value = *addr;
@@ -36,11 +45,331 @@ uint64_t measure_access_time_with_level(volatile void *address, uint64_t *level_
     /* Immediately sample the level for that access (before other memory ops) */
     uint64_t lvl = m5_get_last_hit_level();
 
-    uint64_t end = rdtsc();
+    uint64_t end = timer_stop();
 
     memory_fence();
     compiler_barrier();
 
     if (level_out) *level_out = lvl;
     return end - start;
-}
\ No newline at end of file
+}
+
+// ---- Batched latency measurement ----
+
+static size_t timing_bin(uint64_t cycles)
+{
+    size_t bin = cycles / TIMING_BIN_CYCLES;
+    return bin < TIMING_HIST_BINS ? bin : TIMING_HIST_BINS - 1;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+uint64_t measure_timer_overhead(size_t samples)
+{
+    if (samples == 0) return 0;
+    uint64_t *raw = malloc(samples * sizeof(uint64_t));
+    if (!raw) {
+        perror("malloc timer overhead");
+        exit(1);
+    }
+
+    for (size_t i = 0; i < samples; i++) {
+        uint64_t start = timer_start();
+        raw[i] = timer_stop() - start;
+    }
+    qsort(raw, samples, sizeof(uint64_t), cmp_u64);
+
+    uint64_t median = raw[samples / 2];
+    free(raw);
+    return median;
+}
+
+static inline uint64_t record_latency(uint64_t cycles, uint64_t baseline, size_t i,
+                                      uint64_t *latencies, uint32_t *hist)
+{
+    uint64_t t = cycles > baseline ? cycles - baseline : 0;
+    if (latencies) latencies[i] = t;
+    if (hist) hist[timing_bin(t)]++;
+    return t;
+}
+
+uint64_t measure_access_batch(volatile void *const *addresses, size_t n, uint64_t baseline,
+                              uint64_t *latencies, uint32_t *hist)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        volatile const uint8_t *p = (volatile const uint8_t *)addresses[i];
+
+        uint64_t start = timer_start();
+        uint8_t value = *p;
+        uint64_t end = timer_stop();
+        (void)value;
+
+        sum += record_latency(end - start, baseline, i, latencies, hist);
+    }
+    return sum;
+}
+
+uint64_t measure_chain_batch(uintptr_t head, size_t n, uint64_t baseline,
+                             uint64_t *latencies, uint32_t *hist, size_t *hops_out)
+{
+    uint64_t sum = 0;
+    size_t hops = 0;
+    uintptr_t p = head;
+
+    while (p && hops < n) {
+        uint64_t start = timer_start();
+        p = evlist_next(p);
+        uint64_t end = timer_stop();
+
+        sum += record_latency(end - start, baseline, hops, latencies, hist);
+        hops++;
+    }
+
+    if (hops_out) *hops_out = hops;
+    return sum;
+}
+
+double measure_chain_mean(uintptr_t head, size_t hops, uint64_t baseline)
+{
+    if (hops == 0) return 0.0;
+
+    uintptr_t p = head;
+    uint64_t start = timer_start();
+    for (size_t i = 0; i < hops && p; i++)
+        p = evlist_next(p);
+    uint64_t end = timer_stop();
+
+    // Keep the chase alive, its result is otherwise unused
+    asm volatile("" :: "r"(p) : "memory");
+
+    uint64_t total = end - start;
+    total = total > baseline ? total - baseline : 0;
+    return (double)total / (double)hops;
+}
+
+uint64_t latency_hist_quantile(const uint32_t *hist, double q)
+{
+    uint64_t total = 0;
+    for (size_t b = 0; b < TIMING_HIST_BINS; b++) total += hist[b];
+    if (total == 0) return 0;
+
+    uint64_t rank = (uint64_t)(q * (double)total);
+    uint64_t seen = 0;
+    for (size_t b = 0; b < TIMING_HIST_BINS; b++) {
+        seen += hist[b];
+        if (seen > rank) return (uint64_t)b * TIMING_BIN_CYCLES;
+    }
+    return (uint64_t)(TIMING_HIST_BINS - 1) * TIMING_BIN_CYCLES;
+}
+
+// ---- Latency calibration ----
+
+static void walk_buffer(const uint8_t *buf, size_t bytes, size_t line)
+{
+    volatile uint8_t tmp;
+    for (size_t off = 0; off < bytes; off += line)
+        tmp = ((volatile const uint8_t *)buf)[off];
+    (void)tmp;
+}
+
+// Bring @target into @level (or push it out of every cache for TIMING_MEM), then time a reload
+static uint64_t sample_level(timing_level_t level, volatile uint8_t *target,
+                             const uint8_t *buf, const cache_config_t *cfg)
+{
+    volatile uint8_t tmp = *target;
+    (void)tmp;
+
+    switch (level) {
+    case TIMING_L2:
+        walk_buffer(buf, cfg->l2_size / 4, cfg->cache_line_size);
+        break;
+    case TIMING_EVICTED:
+        walk_buffer(buf, cfg->l2_size * 2, cfg->cache_line_size);
+        break;
+    case TIMING_MEM:
+        _mm_clflush((const void *)target);
+        break;
+    default:
+        break;
+    }
+    memory_fence();
+
+    return measure_access_time(target);
+}
+
+// Cut between two histograms with the fewest samples on the wrong side, middle of the ties
+static uint64_t pick_threshold(const uint32_t *fast, const uint32_t *slow)
+{
+    uint64_t fast_above = 0, slow_upto = 0;
+    for (size_t b = 0; b < TIMING_HIST_BINS; b++) fast_above += fast[b];
+
+    uint64_t best = UINT64_MAX;
+    size_t first = 0, last = 0;
+    for (size_t b = 0; b < TIMING_HIST_BINS; b++) {
+        fast_above -= fast[b];
+        slow_upto += slow[b];
+        uint64_t err = fast_above + slow_upto;
+        if (err < best) {
+            best = err;
+            first = last = b;
+        } else if (err == best) {
+            last = b;
+        }
+    }
+
+    size_t bin = (first + last) / 2;
+    return (uint64_t)(bin + 1) * TIMING_BIN_CYCLES - 1;
+}
+
+static uint8_t *alloc_walk_buffer(const cache_config_t *cfg)
+{
+    uint8_t *buf = aligned_alloc(cfg->page_size, cfg->l2_size * 2);
+    if (!buf) {
+        perror("aligned_alloc calibration buffer");
+        exit(1);
+    }
+    memset(buf, 0x5A, cfg->l2_size * 2);
+    return buf;
+}
+
+void calibrate_cache_timing(cache_timing_t *timing, const cache_config_t *cfg, size_t samples)
+{
+    memset(timing, 0, sizeof(*timing));
+    timing->magic = CACHE_TIMING_MAGIC;
+    timing->version = CACHE_TIMING_VERSION;
+    timing->associativity = cfg->associativity;
+    timing->cache_line_size = cfg->cache_line_size;
+    timing->l2_size = cfg->l2_size;
+    timing->samples = samples;
+
+    uint8_t *buf = alloc_walk_buffer(cfg);
+    uint8_t *target = aligned_alloc(cfg->cache_line_size, cfg->cache_line_size);
+    uint64_t *raw = malloc(TIMING_LEVELS * samples * sizeof(uint64_t));
+    if (!target || !raw) {
+        perror("malloc calibration");
+        exit(1);
+    }
+    memset(target, 0xAB, cfg->cache_line_size);
+
+    // Interleave the levels so that frequency changes spread over all of them
+    for (size_t i = 0; i < samples; i++) {
+        for (int level = 0; level < TIMING_LEVELS; level++) {
+            uint64_t t = sample_level((timing_level_t)level, target, buf, cfg);
+            raw[level * samples + i] = t;
+            timing->hist[level][timing_bin(t)]++;
+        }
+    }
+
+    for (int level = 0; level < TIMING_LEVELS; level++) {
+        qsort(&raw[level * samples], samples, sizeof(uint64_t), cmp_u64);
+        timing->median[level] = samples ? raw[level * samples + samples / 2] : 0;
+    }
+    for (int level = 0; level + 1 < TIMING_LEVELS; level++)
+        timing->threshold[level] = pick_threshold(timing->hist[level], timing->hist[level + 1]);
+
+    free(raw);
+    free(target);
+    free(buf);
+}
+
+int check_cache_timing(const cache_timing_t *timing, const cache_config_t *cfg, size_t samples)
+{
+    uint8_t *buf = alloc_walk_buffer(cfg);
+    uint8_t *target = aligned_alloc(cfg->cache_line_size, cfg->cache_line_size);
+    if (!target) {
+        perror("aligned_alloc calibration target");
+        exit(1);
+    }
+    memset(target, 0xAB, cfg->cache_line_size);
+
+    uint64_t threshold = cache_timing_eviction_threshold(timing);
+    size_t hits_ok = 0, misses_ok = 0;
+    for (size_t i = 0; i < samples; i++) {
+        hits_ok += sample_level(TIMING_L1, target, buf, cfg) <= threshold;
+        misses_ok += sample_level(TIMING_EVICTED, target, buf, cfg) > threshold;
+    }
+
+    free(target);
+    free(buf);
+    return hits_ok * 10 >= samples * 9 && misses_ok * 10 >= samples * 9;
+}
+
+int save_cache_timing(const char *path, const cache_timing_t *timing)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        perror("fopen calibration file");
+        return -1;
+    }
+    size_t written = fwrite(timing, sizeof(*timing), 1, f);
+    if (fclose(f) != 0 || written != 1) {
+        perror("write calibration file");
+        return -1;
+    }
+    return 0;
+}
+
+int load_cache_timing(const char *path, cache_timing_t *timing, const cache_config_t *cfg)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) return -1;
+
+    size_t got = fread(timing, sizeof(*timing), 1, f);
+    fclose(f);
+
+    if (got != 1 || timing->magic != CACHE_TIMING_MAGIC ||
+        timing->version != CACHE_TIMING_VERSION)
+        return -1;
+    if (timing->associativity != cfg->associativity ||
+        timing->cache_line_size != cfg->cache_line_size ||
+        timing->l2_size != cfg->l2_size)
+        return -1;
+    return 0;
+}
+
+cache_timing_t *setup_cache_timing(test_context_t *context, const cache_config_t *cfg)
+{
+    cache_timing_t *timing = malloc(sizeof(cache_timing_t));
+    if (!timing) {
+        perror("malloc cache timing");
+        exit(1);
+    }
+    context->calibration_data = timing;
+
+    const char *path = context->calibration_file;
+    if (path && load_cache_timing(path, timing, cfg) == 0) {
+        if (context->skip_calibration ||
+            check_cache_timing(timing, cfg, TIMING_CHECK_SAMPLES)) {
+            printf("[Timing] loaded calibration from %s\n", path);
+            return timing;
+        }
+        printf("[Timing] calibration in %s no longer matches, recalibrating\n", path);
+    }
+
+    printf("[Timing] calibrating (%d samples per level)\n", TIMING_CALIBRATION_SAMPLES);
+    calibrate_cache_timing(timing, cfg, TIMING_CALIBRATION_SAMPLES);
+    if (path && save_cache_timing(path, timing) == 0)
+        printf("[Timing] saved calibration to %s\n", path);
+    return timing;
+}
+
+void print_cache_timing(const cache_timing_t *timing)
+{
+    static const char *names[TIMING_LEVELS] = { "L1", "L2", "evicted", "memory" };
+
+    printf("Access latency (cycles, %lu samples per level):\n", (unsigned long)timing->samples);
+    for (int level = 0; level < TIMING_LEVELS; level++) {
+        printf("  %-8s median %4lu", names[level], (unsigned long)timing->median[level]);
+        if (level + 1 < TIMING_LEVELS)
+            printf("   threshold to %-8s %4lu", names[level + 1],
+                   (unsigned long)timing->threshold[level]);
+        printf("\n");
+    }
+    printf("  Eviction threshold: %lu cycles\n",
+           (unsigned long)cache_timing_eviction_threshold(timing));
+}
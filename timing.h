@@ -2,8 +2,11 @@
 #define TIMING_H
 
 #include <stdint.h>
+#include <stddef.h>
 #include <x86intrin.h>
 
+#include "threshold_group_testing.h"
+
 
 static inline uint64_t rdtsc() {
     return __rdtsc();
@@ -17,6 +20,138 @@ static inline void compiler_barrier() {
     asm volatile("" ::: "memory");
 }
 
+/*
+* Serialized timestamps: timer_start() waits for earlier instructions before
+* reading the counter and keeps later loads behind it, timer_stop() reads it
+* only after every earlier load has completed
+*/
+static inline uint64_t timer_start() {
+    _mm_lfence();
+    uint64_t t = __rdtsc();
+    _mm_lfence();
+    return t;
+}
+
+static inline uint64_t timer_stop() {
+    unsigned int aux;
+    uint64_t t = __rdtscp(&aux);
+    _mm_lfence();
+    return t;
+}
+
 uint64_t measure_access_time(volatile void *address);
 
-#endif
\ No newline at end of file
+// Same as measure_access_time(), @level_out receives m5_get_last_hit_level() of the access
+uint64_t measure_access_time_with_level(volatile void *address, uint64_t *level_out);
+
+
+// ---- Batched latency measurement ----
+
+#define TIMING_HIST_BINS   256
+#define TIMING_BIN_CYCLES  4        // histogram resolution, the last bin collects the tail
+
+/*
+* Median cost of an empty timer_start()/timer_stop() pair over @samples runs,
+* the baseline the batched measurements subtract
+*/
+uint64_t measure_timer_overhead(size_t samples);
+
+/*
+* Time each of addresses[0..n) on its own
+* @baseline: Subtracted from every sample (clamped at 0)
+* @latencies: Per-access latency out, may be NULL
+* @hist: TIMING_HIST_BINS counters the samples are added to, may be NULL
+* Returns the sum of the latencies
+*/
+uint64_t measure_access_batch(volatile void *const *addresses, size_t n, uint64_t baseline,
+                              uint64_t *latencies, uint32_t *hist);
+
+/*
+* Time each hop of the pointer chain starting at @head (see evlist.h), at most @n hops
+* Same outputs as measure_access_batch(), @hops_out receives the number of hops taken
+*/
+uint64_t measure_chain_batch(uintptr_t head, size_t n, uint64_t baseline,
+                             uint64_t *latencies, uint32_t *hist, size_t *hops_out);
+
+/*
+* One timed traversal of @hops hops, the overhead is paid once for the whole chain
+* Returns the mean latency per hop with @baseline taken out
+*/
+double measure_chain_mean(uintptr_t head, size_t hops, uint64_t baseline);
+
+// Latency at quantile @q (0..1) of a histogram, at bin resolution
+uint64_t latency_hist_quantile(const uint32_t *hist, double q);
+
+
+// ---- Latency calibration for the timing oracle ----
+
+typedef enum {
+    TIMING_L1 = 0,      // reload right after an access
+    TIMING_L2,          // after walking a buffer larger than L1 but well inside L2
+    TIMING_EVICTED,     // after walking twice the configured cache: what the oracle calls evicted
+    TIMING_MEM,         // after clflush
+    TIMING_LEVELS
+} timing_level_t;
+
+#define CACHE_TIMING_MAGIC   0x454d4954u   // "TIME"
+#define CACHE_TIMING_VERSION 1
+
+/*
+* Per-level access latency histograms and the thresholds derived from them.
+* Written to and read from calibration files as is, so the layout is versioned.
+*/
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    // Cache configuration the calibration was measured for
+    uint64_t associativity;
+    uint64_t cache_line_size;
+    uint64_t l2_size;
+
+    uint64_t samples;                                   // per level
+    uint32_t hist[TIMING_LEVELS][TIMING_HIST_BINS];
+    uint64_t median[TIMING_LEVELS];
+    // threshold[i]: an access slower than this did not hit in level i
+    uint64_t threshold[TIMING_LEVELS - 1];
+} cache_timing_t;
+
+// Latency above which the timing oracle reports the target as evicted from the configured cache
+static inline uint64_t cache_timing_eviction_threshold(const cache_timing_t *timing) {
+    return timing->threshold[TIMING_L2];
+}
+
+// Same for cache level @level (1 = L1), the calibration only tells L1 from the rest
+static inline uint64_t cache_timing_level_threshold(const cache_timing_t *timing, int level) {
+    return level == 1 ? timing->threshold[TIMING_L1] : cache_timing_eviction_threshold(timing);
+}
+
+/*
+* Measure @samples accesses per level and pick every threshold as the cut that
+* misclassifies the fewest samples of the two neighbouring levels
+*/
+void calibrate_cache_timing(cache_timing_t *timing, const cache_config_t *cfg, size_t samples);
+
+/*
+* Short sanity check of a loaded calibration: hits must stay below the eviction
+* threshold and evicted lines above it
+* Returns 1 when at least 90% of @samples accesses of either kind classify correctly
+*/
+int check_cache_timing(const cache_timing_t *timing, const cache_config_t *cfg, size_t samples);
+
+// Returns 0 on success, -1 on I/O error
+int save_cache_timing(const char *path, const cache_timing_t *timing);
+
+// Returns 0 on success, -1 if missing, of another version or measured for another cache
+int load_cache_timing(const char *path, cache_timing_t *timing, const cache_config_t *cfg);
+
+/*
+* Calibration for the timing oracle, stored in context->calibration_data
+* Loads context->calibration_file when it matches @cfg (and passes the sanity
+* check unless context->skip_calibration is set), otherwise calibrates and
+* writes the file. The caller frees context->calibration_data.
+*/
+cache_timing_t *setup_cache_timing(test_context_t *context, const cache_config_t *cfg);
+
+void print_cache_timing(const cache_timing_t *timing);
+
+#endif
@@ -1,36 +1,171 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <gem5/m5ops.h>
 #include "timing.h"
+#include "evlist.h"
+#include "prng.h"
 
-int main() {
-    const size_t array_size = 1 << 20; // 1 MB
-    uint8_t *array = aligned_alloc(64, array_size);
-    if (!array) {
+/*
+* lat_mem_rd-style memory hierarchy profiler: a pointer chain over a working
+* set of growing size, walked at a fixed stride (or in random order to defeat
+* the prefetchers). Each point prints the mean load-to-use latency, per-hop
+* percentiles, and the hit levels sampled with m5_get_last_hit_level().
+*/
+
+#define MAX_STRIDES 8
+#define LEVEL_SAMPLES 4096
+
+static size_t parse_list(const char *arg, size_t *out, size_t max)
+{
+    size_t n = 0;
+    char *copy = strdup(arg);
+    for (char *tok = strtok(copy, ","); tok && n < max; tok = strtok(NULL, ",")) {
+        out[n++] = (size_t)strtoul(tok, NULL, 0);
+    }
+    free(copy);
+    return n;
+}
+
+// lat_mem_rd steps: every power of two and the midpoint to the next one
+static size_t next_size(size_t size)
+{
+    if ((size & (size - 1)) == 0) return size + size / 2;
+    size_t p = 1;
+    while (p < size) p <<= 1;
+    return p;
+}
+
+/*
+* Link the lines buf[0], buf[stride], ... below @size into a closed chain
+* Backwards like lat_mem_rd, or shuffled from @rng when it is not NULL
+*/
+static uintptr_t build_chain(uint8_t *buf, size_t size, size_t stride,
+                             uintptr_t *lines, prng_t *rng)
+{
+    size_t count = size / stride;
+    for (size_t i = 0; i < count; i++)
+        lines[i] = (uintptr_t)(buf + (count - 1 - i) * stride);
+
+    if (rng) {
+        for (size_t i = count - 1; i > 0; i--) {
+            size_t j = prng_below(rng, i + 1);
+            uintptr_t tmp = lines[i];
+            lines[i] = lines[j];
+            lines[j] = tmp;
+        }
+    }
+
+    uintptr_t head = evlist_link(lines, count);
+    evlist_set_next(lines[count - 1], head);
+    return head;
+}
+
+// Hit level of each of @n hops, levels above 3 are counted as 3
+static void sample_levels(uintptr_t head, size_t n, uint64_t counts[4])
+{
+    uintptr_t p = head;
+    memset(counts, 0, 4 * sizeof(uint64_t));
+    for (size_t i = 0; i < n; i++) {
+        p = evlist_next(p);
+        uint64_t lvl = m5_get_last_hit_level();
+        counts[lvl > 3 ? 3 : lvl]++;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    size_t min_size = 4 * 1024;
+    size_t max_size = 8 * 1024 * 1024;
+    size_t strides[MAX_STRIDES] = { 64, 256 };
+    size_t n_strides = 2;
+    size_t hops = 0;
+    int random_order = 0;
+    int levels = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--min-size") == 0 && i + 1 < argc) {
+            min_size = (size_t)strtoul(argv[++i], NULL, 0) * 1024;
+        } else if (strcmp(argv[i], "--max-size") == 0 && i + 1 < argc) {
+            max_size = (size_t)strtoul(argv[++i], NULL, 0) * 1024;
+        } else if (strcmp(argv[i], "--strides") == 0 && i + 1 < argc) {
+            n_strides = parse_list(argv[++i], strides, MAX_STRIDES);
+        } else if (strcmp(argv[i], "--hops") == 0 && i + 1 < argc) {
+            hops = (size_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--random") == 0) {
+            random_order = 1;
+        } else if (strcmp(argv[i], "--no-level") == 0) {
+            levels = 0;
+        } else if (strcmp(argv[i], "--help") == 0) {
+            printf("Usage: %s [--min-size <KB>] [--max-size <KB>] [--strides <a,b,..>]"
+                   " [--hops <N>] [--random] [--no-level]\n", argv[0]);
+            printf("  --hops N    timed hops per point (default: two passes, at least 4096)\n");
+            printf("  --random    chain the lines in random order instead of a fixed stride\n");
+            printf("  --no-level  skip m5_get_last_hit_level() sampling (native runs)\n");
+            return 0;
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (min_size < 4096) min_size = 4096;
+
+    uint8_t *array = aligned_alloc(4096, max_size);
+    uintptr_t *lines = malloc((max_size / sizeof(uintptr_t)) * sizeof(uintptr_t));
+    if (!array || !lines) {
         perror("alloc failed");
         return 1;
     }
 
     // Touch every page to ensure mapping
-    for (size_t i = 0; i < array_size; i += 4096)
-        array[i] = 1;
+    memset(array, 0, max_size);
 
-    // Warm up first line (make it cached)
-    for (int i = 0; i < 1000; i++) {
-        volatile uint8_t tmp = array[0];
-        (void)tmp;
-    }
+    prng_t rng;
+    prng_seed(&rng, 1);
+
+    uint64_t baseline = measure_timer_overhead(1000);
+    printf("Timer overhead (lfence/rdtscp pair): %lu cycles, subtracted below\n",
+           (unsigned long)baseline);
+    printf("%6s %10s %10s %6s %6s %6s %6s %6s\n",
+           "stride", "size_kb", "cyc/load", "p50", "p90", "L1%", "L2%", "mem%");
 
-    uint64_t lvl_cached = 0, lvl_far = 0;
-    uint64_t cached = measure_access_time_with_level(&array[0], &lvl_cached);
-    uint64_t cold   = measure_access_time_with_level(&array[array_size - 64], &lvl_far);
+    for (size_t s = 0; s < n_strides; s++) {
+        size_t stride = strides[s];
+        if (stride < sizeof(uintptr_t)) continue;
 
-    printf("Cached access: %lu cycles, hit level = %lu\n",
-           (unsigned long)cached, (unsigned long)lvl_cached);
-    printf("Far (likely uncached) access: %lu cycles, hit level = %lu\n",
-           (unsigned long)cold, (unsigned long)lvl_far);
+        for (size_t size = min_size; size <= max_size; size = next_size(size)) {
+            size_t count = size / stride;
+            if (count < 2) continue;
+
+            uintptr_t head = build_chain(array, size, stride, lines,
+                                         random_order ? &rng : NULL);
+            size_t n = hops ? hops : (2 * count > 4096 ? 2 * count : 4096);
+
+            // Warm up: one full pass
+            measure_chain_mean(head, count, 0);
+            double mean = measure_chain_mean(head, n, baseline);
+
+            uint32_t hist[TIMING_HIST_BINS] = { 0 };
+            size_t sampled = count < LEVEL_SAMPLES ? count : LEVEL_SAMPLES;
+            measure_chain_batch(head, sampled, baseline, NULL, hist, NULL);
+
+            printf("%6zu %10.1f %10.2f %6lu %6lu", stride, size / 1024.0, mean,
+                   (unsigned long)latency_hist_quantile(hist, 0.50),
+                   (unsigned long)latency_hist_quantile(hist, 0.90));
+
+            if (levels) {
+                uint64_t counts[4];
+                sample_levels(head, sampled, counts);
+                printf(" %6.1f %6.1f %6.1f",
+                       100.0 * counts[1] / sampled, 100.0 * counts[2] / sampled,
+                       100.0 * counts[3] / sampled);
+            }
+            printf("\n");
+        }
+    }
 
+    free(lines);
     free(array);
     return 0;
 }
@@ -0,0 +1,31 @@
+#include "traversal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *dir_names[] = { "fwd", "bwd", "zigzag" };
+
+int parse_traversal_pattern(const char *spec, traversal_pattern_t *out)
+{
+    char dir[16] = "fwd";
+    unsigned repeat = 0, window = 0;
+
+    int fields = sscanf(spec, "%u:%u:%15s", &repeat, &window, dir);
+    if (fields < 1 || repeat == 0) return 0;
+
+    for (int d = 0; d < 3; d++) {
+        if (strcmp(dir, dir_names[d]) == 0) {
+            out->repeat = repeat;
+            out->window = window;
+            out->dir = (traversal_dir_t)d;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void format_traversal_pattern(const traversal_pattern_t *p, char *buf, size_t len)
+{
+    snprintf(buf, len, "%u:%u:%s", p->repeat, p->window, dir_names[p->dir]);
+}
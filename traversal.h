@@ -0,0 +1,88 @@
+#ifndef TRAVERSAL_H
+#define TRAVERSAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "threshold_group_testing.h"
+#include "evlist.h"
+
+typedef enum {
+    TRAVERSE_FORWARD = 0,
+    TRAVERSE_BACKWARD,
+    TRAVERSE_ZIGZAG         // forward on even repetitions, backward on odd ones
+} traversal_dir_t;
+
+/*
+* Access pattern of an oracle traversal: a window of @window lines slides over
+* the set one line at a time and every window is walked @repeat times.
+* window = 0 (or >= set size) walks the whole set, {1, 0, forward} is the
+* single linear pass. Pointer chains only honour @repeat.
+*/
+typedef struct traversal_pattern {
+    unsigned repeat;
+    unsigned window;
+    traversal_dir_t dir;
+} traversal_pattern_t;
+
+/*
+* Loads one traversal of a @size-line set costs (a NULL pattern is one pass)
+* @chain: the set is walked as a pointer chain, where only @repeat applies
+*/
+static inline uint64_t traversal_pattern_loads(const traversal_pattern_t *p, size_t size, int chain) {
+    if (!p) return size;
+    if (chain) return (uint64_t)size * (p->repeat ? p->repeat : 1);
+    size_t window = (p->window && p->window < size) ? p->window : size;
+    size_t windows = size ? size - window + 1 : 0;
+    return (uint64_t)windows * (p->repeat ? p->repeat : 1) * window;
+}
+
+/*
+* Walk @set following @p, calling @visit on every line, or loading it when @visit is NULL
+* Inlined into every oracle, so a constant @visit costs no indirect call
+*/
+static inline void traverse_pattern(const address_set_t *set, const traversal_pattern_t *p,
+                                    void (*visit)(uintptr_t, void *), void *arg)
+{
+    unsigned repeat = (p && p->repeat) ? p->repeat : 1;
+
+    if (set->chain) {
+        for (unsigned r = 0; r < repeat; r++) {
+            if (!visit) {
+                evlist_traverse(set->chain);
+                continue;
+            }
+            for (uintptr_t q = set->chain; q; q = evlist_next(q)) visit(q, arg);
+        }
+        return;
+    }
+
+    size_t n = set->size;
+    size_t window = (p && p->window && p->window < n) ? p->window : n;
+    traversal_dir_t dir = p ? p->dir : TRAVERSE_FORWARD;
+    volatile uint8_t tmp;
+
+    for (size_t start = 0; start + window <= n && window; start++) {
+        for (unsigned r = 0; r < repeat; r++) {
+            int backward = dir == TRAVERSE_BACKWARD || (dir == TRAVERSE_ZIGZAG && (r & 1));
+            for (size_t k = 0; k < window; k++) {
+                uintptr_t addr = set->addresses[backward ? start + window - 1 - k : start + k];
+                if (visit) visit(addr, arg);
+                else tmp = *(volatile uint8_t *)addr;
+            }
+        }
+    }
+    (void)tmp;
+    asm volatile("" ::: "memory");
+}
+
+/*
+* Parse "repeat:window:dir" (dir = fwd, bwd or zigzag), e.g. "2:0:zigzag"
+* Returns 1 on success
+*/
+int parse_traversal_pattern(const char *spec, traversal_pattern_t *out);
+
+// Same format as parse_traversal_pattern(), into @buf of @len bytes
+void format_traversal_pattern(const traversal_pattern_t *p, char *buf, size_t len);
+
+#endif //TRAVERSAL_H
@@ -0,0 +1,62 @@
+#include "voting_oracle.h"
+
+#include <math.h>
+#include <stdio.h>
+
+void voting_oracle_init(voting_oracle_t *vote)
+{
+    vote->inner = NULL;
+    vote->p_evict = 0.95;
+    vote->p_false = 0.01;
+    vote->alpha = 0.005;
+    vote->beta = 0.06;
+    vote->max_samples = 9;
+    vote->decisions = 0;
+    vote->samples = 0;
+    vote->forced = 0;
+    voting_oracle_configure(vote);
+}
+
+void voting_oracle_configure(voting_oracle_t *vote)
+{
+    vote->llr_one  = log(vote->p_evict / vote->p_false);
+    vote->llr_zero = log((1.0 - vote->p_evict) / (1.0 - vote->p_false));
+    vote->upper    = log((1.0 - vote->beta) / vote->alpha);
+    vote->lower    = log(vote->beta / (1.0 - vote->alpha));
+    if (vote->max_samples == 0) vote->max_samples = 1;
+}
+
+static int voting_eviction_test(const address_set_t *set,
+                                const test_context_t *context)
+{
+    voting_oracle_t *vote = context->vote;
+    double llr = 0.0;
+
+    vote->decisions++;
+    for (unsigned n = 1; ; n++) {
+        llr += vote->inner(set, context) ? vote->llr_one : vote->llr_zero;
+        vote->samples++;
+
+        // Small epsilon: one clean sample sitting exactly on a bound decides
+        if (llr >= vote->upper - 1e-9) return 1;
+        if (llr <= vote->lower + 1e-9) return 0;
+        if (n >= vote->max_samples) {
+            vote->forced++;
+            return llr >= 0.0;
+        }
+    }
+}
+
+eviction_test_func_t voting_oracle_wrap(voting_oracle_t *vote, eviction_test_func_t inner)
+{
+    vote->inner = inner;
+    return voting_eviction_test;
+}
+
+void voting_oracle_print(const voting_oracle_t *vote)
+{
+    printf("Voting oracle: %lu decisions, %lu samples (%.2f per decision), %lu forced\n",
+           (unsigned long)vote->decisions, (unsigned long)vote->samples,
+           vote->decisions ? (double)vote->samples / (double)vote->decisions : 0.0,
+           (unsigned long)vote->forced);
+}
@@ -0,0 +1,60 @@
+#ifndef VOTING_ORACLE_H
+#define VOTING_ORACLE_H
+
+#include <stdint.h>
+
+#include "threshold_group_testing.h"
+
+/*
+* Sequential probability ratio test over repeated eviction tests.
+* Each sample of @inner moves the log-likelihood ratio of "the set evicts"
+* against "it does not"; sampling stops as soon as one of the Wald bounds is
+* crossed, so an unambiguous answer costs one or two traversals, not a fixed vote.
+* The wrapper finds this struct through context->vote.
+*/
+typedef struct voting_oracle {
+    eviction_test_func_t inner;
+
+    double p_evict;         // P(sample = 1 | set evicts)
+    double p_false;         // P(sample = 1 | set does not evict)
+    double alpha;           // bound on wrongly answering "evicts"
+    double beta;            // bound on wrongly answering "does not evict"
+    unsigned max_samples;   // forced decision (sign of the LLR) after this many
+
+    double llr_one;         // LLR step for a positive sample
+    double llr_zero;        // LLR step for a negative sample
+    double upper;           // log((1 - beta) / alpha)
+    double lower;           // log(beta / (1 - alpha))
+
+    uint64_t decisions;
+    uint64_t samples;
+    uint64_t forced;        // decisions that hit max_samples
+} voting_oracle_t;
+
+
+/*
+* Defaults: p_evict=0.95, p_false=0.01, alpha=0.005, beta=0.06, max_samples=9.
+* With these a single negative sample decides and a positive one needs a second
+* positive to confirm it; a contradicting sample keeps the test going.
+* The confirmation is deliberate: it doubles the cost of every positive (LRU
+* reductions take 7 -> 14 calls), but on PLRU and RRIP a set one congruent line
+* short evicts when the previous test left that line out, and only a re-test
+* catches it. With alpha above p_false / p_evict * (1 - beta) (about 0.0099)
+* one positive decides, and the model benchmark (8 ways, pool 256, 40 seeds)
+* drops from 40/40 to 19/40 correct sets on PLRU and 8/40 on RRIP, the same as
+* without --vote.
+*/
+void voting_oracle_init(voting_oracle_t *vote);
+
+// Recompute the LLR steps and bounds after changing the parameters
+void voting_oracle_configure(voting_oracle_t *vote);
+
+/*
+* Install @inner behind the voting wrapper
+* @vote: Initialised parameters, must also be stored in context->vote
+*/
+eviction_test_func_t voting_oracle_wrap(voting_oracle_t *vote, eviction_test_func_t inner);
+
+void voting_oracle_print(const voting_oracle_t *vote);
+
+#endif //VOTING_ORACLE_H